@@ -67,6 +67,21 @@ int main(int argc, char *argv[])
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     
+    //the quad never changes, so it goes into buffer objects once instead of being copied from the stack every draw
+    float vertices[] = {-0.5, -0.5, 0.5, -0.5, 0.5, 0.5, -0.5, -0.5, 0.5, 0.5, -0.5, 0.5};
+    float texCoords[] = {0.0, 1.0, 1.0, 1.0, 1.0, 0.0, 0.0, 1.0, 1.0, 0.0, 0.0, 0.0};
+    
+    GLuint vertexBuffer;
+    glGenBuffers(1, &vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    
+    GLuint texCoordBuffer;
+    glGenBuffers(1, &texCoordBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, texCoordBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(texCoords), texCoords, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    
 	SDL_Event event;
 	bool done = false;
 	while (!done) {
@@ -83,55 +98,28 @@ int main(int argc, char *argv[])
         
         program.SetProjectionMatrix(projectionMatrix);
         
-        //FIRST TEXTURE DRAWN
-        program.SetModelviewMatrix(modelviewMatrix1);
-        
-        glBindTexture(GL_TEXTURE_2D, Texture1);
-        
-        float vertices[] = {-0.5, -0.5, 0.5, -0.5, 0.5, 0.5, -0.5, -0.5, 0.5, 0.5, -0.5, 0.5};
-        glVertexAttribPointer(program.positionAttribute, 2, GL_FLOAT, false, 0, vertices);
+        //all three sprites share the quad that was uploaded before the loop
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glVertexAttribPointer(program.positionAttribute, 2, GL_FLOAT, false, 0, 0);
         glEnableVertexAttribArray(program.positionAttribute);
         
-        float texCoords[] = {0.0, 1.0, 1.0, 1.0, 1.0, 0.0, 0.0, 1.0, 1.0, 0.0, 0.0, 0.0};
-        glVertexAttribPointer(program.texCoordAttribute, 2, GL_FLOAT, false, 0, texCoords);
+        glBindBuffer(GL_ARRAY_BUFFER, texCoordBuffer);
+        glVertexAttribPointer(program.texCoordAttribute, 2, GL_FLOAT, false, 0, 0);
         glEnableVertexAttribArray(program.texCoordAttribute);
         
+        //FIRST TEXTURE DRAWN
+        program.SetModelviewMatrix(modelviewMatrix1);
+        glBindTexture(GL_TEXTURE_2D, Texture1);
         glDrawArrays(GL_TRIANGLES, 0, 6);
         
-        glDisableVertexAttribArray(program.positionAttribute);
-        glDisableVertexAttribArray(program.texCoordAttribute);
-        
         //SECOND TEXTURE DRAWN
         program.SetModelviewMatrix(modelviewMatrix2);
-        
         glBindTexture(GL_TEXTURE_2D, Texture2);
-        
-        float vertices2[] = {-0.5, -0.5, 0.5, -0.5, 0.5, 0.5, -0.5, -0.5, 0.5, 0.5, -0.5, 0.5};
-        glVertexAttribPointer(program.positionAttribute, 2, GL_FLOAT, false, 0, vertices2);
-        glEnableVertexAttribArray(program.positionAttribute);
-        
-        float texCoords2[] = {0.0, 1.0, 1.0, 1.0, 1.0, 0.0, 0.0, 1.0, 1.0, 0.0, 0.0, 0.0};
-        glVertexAttribPointer(program.texCoordAttribute, 2, GL_FLOAT, false, 0, texCoords2);
-        glEnableVertexAttribArray(program.texCoordAttribute);
-        
         glDrawArrays(GL_TRIANGLES, 0, 6);
         
-        glDisableVertexAttribArray(program.positionAttribute);
-        glDisableVertexAttribArray(program.texCoordAttribute);
-        
         //THIRD TEXTURE DRAWN
         program.SetModelviewMatrix(modelviewMatrix3);
-        
         glBindTexture(GL_TEXTURE_2D, Texture3);
-        
-        float vertices3[] = {-0.5, -0.5, 0.5, -0.5, 0.5, 0.5, -0.5, -0.5, 0.5, 0.5, -0.5, 0.5};
-        glVertexAttribPointer(program.positionAttribute, 2, GL_FLOAT, false, 0, vertices3);
-        glEnableVertexAttribArray(program.positionAttribute);
-        
-        float texCoords3[] = {0.0, 1.0, 1.0, 1.0, 1.0, 0.0, 0.0, 1.0, 1.0, 0.0, 0.0, 0.0};
-        glVertexAttribPointer(program.texCoordAttribute, 2, GL_FLOAT, false, 0, texCoords3);
-        glEnableVertexAttribArray(program.texCoordAttribute);
-        
         glDrawArrays(GL_TRIANGLES, 0, 6);
         
         glDisableVertexAttribArray(program.positionAttribute);
@@ -141,6 +129,8 @@ int main(int argc, char *argv[])
         
 	}
 
+	glDeleteBuffers(1, &vertexBuffer);
+	glDeleteBuffers(1, &texCoordBuffer);
 	SDL_Quit();
 	return 0;
 }
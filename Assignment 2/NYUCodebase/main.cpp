@@ -114,6 +114,20 @@ int main(int argc, char *argv[])
     //0 means up 1 means down
     int y_direction = 0;
     
+    //TOP WALL, BOTTOM WALL, PADDLE and BALL one after another, six vertices each
+    //the shapes never change, so they are uploaded once instead of copied from the stack every draw
+    float vertices[] = {
+        -3.55, -0.1, 3.55, -0.1, 3.55, 0.0, -3.55, -0.1, 3.55, 0.0, -3.55, 0.0,
+        -3.55, 0.0, 3.55, 0.1, 3.55, 0.0, -3.55, 0.0, 3.55, 0.1, -3.55, 0.1,
+        -0.08, -0.5, 0.08, -0.5, 0.08, 0.5, -0.08, -0.5, 0.08, 0.5, -0.08, 0.5,
+        -0.08, -0.08, 0.08, -0.08, 0.08, 0.08, -0.08, -0.08, 0.08, 0.08, -0.08, 0.08
+    };
+    GLuint vertexBuffer;
+    glGenBuffers(1, &vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    
 	SDL_Event event;
 	bool done = false;
 	while (!done) {
@@ -143,61 +157,28 @@ int main(int argc, char *argv[])
         program.SetProjectionMatrix(projectionMatrix);
         
         
+        //every shape comes out of the buffer uploaded before the loop, only the matrices change
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glVertexAttribPointer(program.positionAttribute, 2, GL_FLOAT, false, 0, 0);
+        glEnableVertexAttribArray(program.positionAttribute);
+        
         //MAKING THE TOP AND BOTTOM WALL BOUNDARIES
         program.SetModelviewMatrix(modelviewMatrix3);
-        
-        float vertices3[] = {-3.55, -0.1, 3.55, -0.1, 3.55, 0.0, -3.55, -0.1, 3.55, 0.0, -3.55, 0.0};
-        glVertexAttribPointer(program.positionAttribute, 2, GL_FLOAT, false, 0, vertices3);
-        glEnableVertexAttribArray(program.positionAttribute);
-
-
         glDrawArrays(GL_TRIANGLES, 0, 6);
-
-        glDisableVertexAttribArray(program.positionAttribute);
         
         program.SetModelviewMatrix(modelviewMatrix4);
-        
-        float vertices4[] = {-3.55, 0.0, 3.55, 0.1, 3.55, 0.0, -3.55, 0.0, 3.55, 0.1, -3.55, 0.1};
-        glVertexAttribPointer(program.positionAttribute, 2, GL_FLOAT, false, 0, vertices4);
-        glEnableVertexAttribArray(program.positionAttribute);
-        
-        
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        
-        glDisableVertexAttribArray(program.positionAttribute);
-        
+        glDrawArrays(GL_TRIANGLES, 6, 6);
         
         //MAKING THE RIGHT AND LEFT PADDLES
         program.SetModelviewMatrix(modelviewMatrix);
-        
-        float vertices[] = {-0.08, -0.5, 0.08, -0.5, 0.08, 0.5, -0.08, -0.5, 0.08, 0.5, -0.08, 0.5};
-        glVertexAttribPointer(program.positionAttribute, 2, GL_FLOAT, false, 0, vertices);
-        glEnableVertexAttribArray(program.positionAttribute);
-        
-        
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        
-        glDisableVertexAttribArray(program.positionAttribute);
+        glDrawArrays(GL_TRIANGLES, 12, 6);
         
         program.SetModelviewMatrix(modelviewMatrix2);
-        
-        float vertices2[] = {-0.08, -0.5, 0.08, -0.5, 0.08, 0.5, -0.08, -0.5, 0.08, 0.5, -0.08, 0.5};
-        glVertexAttribPointer(program.positionAttribute, 2, GL_FLOAT, false, 0, vertices2);
-        glEnableVertexAttribArray(program.positionAttribute);
-        
-        
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        
-        glDisableVertexAttribArray(program.positionAttribute);
+        glDrawArrays(GL_TRIANGLES, 12, 6);
         
         //BALL CODE
         program.SetModelviewMatrix(modelviewMatrix5);
-        float vertices5[] = {-0.08, -0.08, 0.08, -0.08, 0.08, 0.08, -0.08, -0.08, 0.08, 0.08, -0.08, 0.08};
-        glVertexAttribPointer(program.positionAttribute, 2, GL_FLOAT, false, 0, vertices5);
-        glEnableVertexAttribArray(program.positionAttribute);
-        
-        
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        glDrawArrays(GL_TRIANGLES, 18, 6);
         
         glDisableVertexAttribArray(program.positionAttribute);
         
@@ -380,6 +361,7 @@ int main(int argc, char *argv[])
 		SDL_GL_SwapWindow(displayWindow);
 	}
 
+	glDeleteBuffers(1, &vertexBuffer);
 	SDL_Quit();
 	return 0;
 }
@@ -0,0 +1,60 @@
+#include "AllocationCounter.h"
+
+#ifdef COUNT_ALLOCATIONS
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+
+//one relaxed increment per allocation
+static std::atomic<size_t> allocations(0);
+
+size_t AllocationCount() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+static void* countedAllocate(size_t bytes) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return malloc(bytes > 0 ? bytes : 1);
+}
+
+void* operator new(size_t bytes) {
+    void *memory = countedAllocate(bytes);
+    if(memory == NULL) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](size_t bytes) {
+    void *memory = countedAllocate(bytes);
+    if(memory == NULL) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new(size_t bytes, const std::nothrow_t &) noexcept {
+    return countedAllocate(bytes);
+}
+
+void* operator new[](size_t bytes, const std::nothrow_t &) noexcept {
+    return countedAllocate(bytes);
+}
+
+void operator delete(void *memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept {
+    free(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept {
+    free(memory);
+}
+
+#endif
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stddef.h>
+
+//builds with COUNT_ALLOCATIONS defined replace the global operator new, so every C++ heap allocation on any thread is counted
+//malloc calls from C libraries and the GL driver are not
+//the CountAllocations build configuration defines COUNT_ALLOCATIONS=1, the shared "NYUCodebase Count Allocations" scheme
+//builds it and runs --count-allocs, Debug and Release keep the standard operator new
+#ifdef COUNT_ALLOCATIONS
+size_t AllocationCount();
+#endif
@@ -0,0 +1,128 @@
+#include "AssetLoader.h"
+#include "GLState.h"
+#include "AssetPack.h"
+#include "TextureCache.h"
+#include <SDL.h>
+#include "JobSystem.h"
+#include <iostream>
+#include <assert.h>
+
+static float secondsSince(Uint64 start) {
+    return (float)(SDL_GetPerformanceCounter() - start) / (float)SDL_GetPerformanceFrequency();
+}
+
+GLuint UploadTexture(const unsigned char *image, int width, int height) {
+    GLuint retTexture;
+    glGenTextures(1, &retTexture);
+    BindTexture(retTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    return retTexture;
+}
+
+GLuint LoadTexture(const char *filePath) {
+    int w,h;
+    unsigned char* image = LoadCachedImage(filePath, &w, &h);
+    if(image == NULL) {
+        std::cout << "Unable to load image. Make sure the path is correct\n";
+        assert(false);
+    }
+    GLuint retTexture = UploadTexture(image, w, h);
+    AlphaMap alpha;
+    alpha.Build(image, w, h);
+    SetTextureAlpha(retTexture, alpha);
+    FreeCachedImage(image);
+    return retTexture;
+}
+
+void AssetLoader::add(AssetType type, const std::string &path, GLuint *texture, Mix_Chunk **sound, Mix_Music **music) {
+    Asset asset;
+    asset.type = type;
+    asset.path = path;
+    asset.texture = texture;
+    asset.sound = sound;
+    asset.music = music;
+    asset.image = NULL;
+    asset.width = 0;
+    asset.height = 0;
+    asset.decodeTime = 0.0f;
+    asset.uploadTime = 0.0f;
+    assets.push_back(asset);
+}
+
+void AssetLoader::AddTexture(const std::string &path, GLuint *texture) {
+    add(ASSET_TEXTURE, path, texture, NULL, NULL);
+}
+
+void AssetLoader::AddSound(const std::string &path, Mix_Chunk **sound) {
+    add(ASSET_SOUND, path, NULL, sound, NULL);
+}
+
+void AssetLoader::AddMusic(const std::string &path, Mix_Music **music) {
+    add(ASSET_MUSIC, path, NULL, NULL, music);
+}
+
+//runs on a worker thread, so nothing in here may touch GL
+void AssetLoader::decode(Asset &asset) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    if(asset.type == ASSET_TEXTURE) {
+        asset.image = LoadCachedImage(asset.path, &asset.width, &asset.height);
+        if(asset.image != NULL) {
+            asset.alpha.Build(asset.image, asset.width, asset.height);
+        }
+    }
+    else if(asset.type == ASSET_SOUND) {
+        //WAVs are converted to the mixer's format here, Mix_OpenAudio has to be called first
+        *asset.sound = Mix_LoadWAV_RW(OpenAssetRW(asset.path), 1);
+        if(*asset.sound == NULL) {
+            asset.error = Mix_GetError();
+        }
+    }
+    else {
+        *asset.music = Mix_LoadMUS_RW(OpenAssetRW(asset.path), 1);
+        if(*asset.music == NULL) {
+            asset.error = Mix_GetError();
+        }
+    }
+    asset.decodeTime = secondsSince(start);
+}
+
+void AssetLoader::LoadAll() {
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    //one job per asset, idle workers steal whatever is left so one big file doesn't hold up the rest
+    //this thread decodes too while it waits
+    JobCounter decoded;
+    for(size_t i = 0; i < assets.size(); i++) {
+        Asset *asset = &assets[i];
+        Jobs().Run([this, asset]() { decode(*asset); }, &decoded);
+    }
+    Jobs().Wait(decoded);
+    int workerCount = Jobs().WorkerCount() + 1;
+
+    float decodeTotal = 0.0f;
+    for(size_t i = 0; i < assets.size(); i++) {
+        Asset &asset = assets[i];
+        if(asset.type == ASSET_TEXTURE) {
+            if(asset.image == NULL) {
+                std::cout << "Unable to load image. Make sure the path is correct\n";
+                assert(false);
+            }
+            Uint64 uploadStart = SDL_GetPerformanceCounter();
+            *asset.texture = UploadTexture(asset.image, asset.width, asset.height);
+            SetTextureAlpha(*asset.texture, asset.alpha);
+            FreeCachedImage(asset.image);
+            asset.image = NULL;
+            asset.uploadTime = secondsSince(uploadStart);
+        }
+        else if((asset.type == ASSET_SOUND && *asset.sound == NULL) || (asset.type == ASSET_MUSIC && *asset.music == NULL)) {
+            std::cout << "Unable to load " << asset.path << ": " << asset.error << std::endl;
+        }
+        decodeTotal += asset.decodeTime;
+        std::cout << "Loaded " << asset.path << " decode " << asset.decodeTime * 1000.0f << "ms upload " << asset.uploadTime * 1000.0f << "ms" << std::endl;
+    }
+    std::cout << "Loaded " << assets.size() << " assets in " << secondsSince(start) * 1000.0f << "ms on " << workerCount
+    << " threads (" << decodeTotal * 1000.0f << "ms of decoding)" << std::endl;
+    assets.clear();
+}
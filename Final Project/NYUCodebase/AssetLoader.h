@@ -0,0 +1,51 @@
+#pragma once
+
+#include "GLPlatform.h"
+#include <SDL_mixer.h>
+#include <string>
+#include <vector>
+#include "TextureAlpha.h"
+
+//decodes and uploads a texture on the calling thread
+GLuint LoadTexture(const char *filePath);
+GLuint UploadTexture(const unsigned char *image, int width, int height);
+
+//loads a batch of assets at once: images and audio are decoded on worker threads,
+//then the textures are uploaded in the order they were added on the thread that owns the GL context
+class AssetLoader {
+    public:
+        void AddTexture(const std::string &path, GLuint *texture);
+        void AddSound(const std::string &path, Mix_Chunk **sound);
+        void AddMusic(const std::string &path, Mix_Music **music);
+
+        //blocks until everything is loaded and prints how long each asset took
+        void LoadAll();
+
+    private:
+        enum AssetType { ASSET_TEXTURE, ASSET_SOUND, ASSET_MUSIC };
+
+        class Asset {
+            public:
+                AssetType type;
+                std::string path;
+
+                GLuint *texture;
+                Mix_Chunk **sound;
+                Mix_Music **music;
+
+                unsigned char *image;
+                int width;
+                int height;
+                AlphaMap alpha;
+
+                float decodeTime;
+                float uploadTime;
+                //SDL errors are per thread, so a failed decode keeps its message for LoadAll() to print
+                std::string error;
+        };
+
+        void add(AssetType type, const std::string &path, GLuint *texture, Mix_Chunk **sound, Mix_Music **music);
+        void decode(Asset &asset);
+
+        std::vector<Asset> assets;
+};
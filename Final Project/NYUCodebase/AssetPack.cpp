@@ -0,0 +1,156 @@
+#include "AssetPack.h"
+#include <string.h>
+#include <iostream>
+#ifdef _WINDOWS
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+AssetPack::AssetPack() : mapped(NULL), mappedSize(0), entries(NULL), entryCount(0) {
+#ifdef _WINDOWS
+    fileHandle = NULL;
+    mappingHandle = NULL;
+#endif
+}
+
+AssetPack::~AssetPack() {
+    Close();
+}
+
+bool AssetPack::Open(const std::string &packFile) {
+    Close();
+#ifdef _WINDOWS
+    HANDLE file = CreateFileA(packFile.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(mapping == NULL) {
+        CloseHandle(file);
+        return false;
+    }
+    mapped = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    fileHandle = file;
+    mappingHandle = mapping;
+    if(mapped == NULL) {
+        Close();
+        return false;
+    }
+    mappedSize = (size_t)fileSize.QuadPart;
+#else
+    int file = open(packFile.c_str(), O_RDONLY);
+    if(file < 0) {
+        return false;
+    }
+    struct stat info;
+    if(fstat(file, &info) != 0 || info.st_size == 0) {
+        close(file);
+        return false;
+    }
+    void *address = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    //the mapping keeps its own reference to the file
+    close(file);
+    if(address == MAP_FAILED) {
+        return false;
+    }
+    mapped = (const unsigned char*)address;
+    mappedSize = (size_t)info.st_size;
+#endif
+
+    const PackHeader *header = (const PackHeader*)mapped;
+    if(mappedSize < sizeof(PackHeader) || memcmp(header->magic, PACK_MAGIC, 4) != 0 || header->version != PACK_VERSION ||
+       mappedSize < sizeof(PackHeader) + (size_t)header->entryCount * sizeof(PackEntry)) {
+        std::cout << "Invalid asset pack:" << packFile << std::endl;
+        Close();
+        return false;
+    }
+    entries = (const PackEntry*)(mapped + sizeof(PackHeader));
+    entryCount = header->entryCount;
+    for(uint32_t i = 0; i < entryCount; i++) {
+        if(entries[i].offset + entries[i].size > mappedSize) {
+            std::cout << "Invalid asset pack:" << packFile << std::endl;
+            Close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void AssetPack::Close() {
+#ifdef _WINDOWS
+    if(mapped != NULL) {
+        UnmapViewOfFile(mapped);
+    }
+    if(mappingHandle != NULL) {
+        CloseHandle((HANDLE)mappingHandle);
+    }
+    if(fileHandle != NULL) {
+        CloseHandle((HANDLE)fileHandle);
+    }
+    fileHandle = NULL;
+    mappingHandle = NULL;
+#else
+    if(mapped != NULL) {
+        munmap((void*)mapped, mappedSize);
+    }
+#endif
+    mapped = NULL;
+    mappedSize = 0;
+    entries = NULL;
+    entryCount = 0;
+}
+
+bool AssetPack::IsOpen() const {
+    return mapped != NULL;
+}
+
+bool AssetPack::Find(const std::string &name, AssetSpan &span) const {
+    //the tool writes the index sorted, so search it in place
+    uint32_t low = 0;
+    uint32_t high = entryCount;
+    while(low < high) {
+        uint32_t middle = (low + high) / 2;
+        int compare = strncmp(entries[middle].name, name.c_str(), PACK_NAME_LENGTH);
+        if(compare == 0) {
+            span.data = mapped + entries[middle].offset;
+            span.size = (size_t)entries[middle].size;
+            return true;
+        }
+        else if(compare < 0) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    return false;
+}
+
+static AssetPack mountedPack;
+
+bool MountAssetPack(const std::string &packFile) {
+    return mountedPack.Open(packFile);
+}
+
+bool FindAsset(const std::string &path, AssetSpan &span) {
+    if(!mountedPack.IsOpen()) {
+        return false;
+    }
+    //assets are stored by file name, RESOURCE_FOLDER is only there for loose files
+    size_t slash = path.find_last_of("/\\");
+    return mountedPack.Find(slash == std::string::npos ? path : path.substr(slash + 1), span);
+}
+
+SDL_RWops* OpenAssetRW(const std::string &path) {
+    AssetSpan span;
+    if(FindAsset(path, span)) {
+        return SDL_RWFromConstMem(span.data, (int)span.size);
+    }
+    return SDL_RWFromFile(path.c_str(), "rb");
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <SDL.h>
+#include <string>
+#include <streambuf>
+#include "PackFormat.h"
+
+//a view into the mapped pack, valid for as long as the pack stays mounted
+class AssetSpan {
+    public:
+        AssetSpan() : data(NULL), size(0) {}
+
+        const unsigned char *data;
+        size_t size;
+};
+
+//lets the text parsers read straight out of the mapped pack with a std::istream
+class MemoryBuffer : public std::streambuf {
+    public:
+        void Set(const AssetSpan &span) {
+            char *start = (char*)span.data;
+            setg(start, start, start + span.size);
+        }
+};
+
+//a memory mapped asset pack, assets are looked up by file name and never copied
+class AssetPack {
+    public:
+        AssetPack();
+        ~AssetPack();
+
+        bool Open(const std::string &packFile);
+        void Close();
+        bool IsOpen() const;
+
+        bool Find(const std::string &name, AssetSpan &span) const;
+
+    private:
+        const unsigned char *mapped;
+        size_t mappedSize;
+        const PackEntry *entries;
+        uint32_t entryCount;
+#ifdef _WINDOWS
+        void *fileHandle;
+        void *mappingHandle;
+#endif
+};
+
+//the loaders look in the mounted pack first and fall back to loose files when it isn't there
+bool MountAssetPack(const std::string &packFile);
+bool FindAsset(const std::string &path, AssetSpan &span);
+SDL_RWops* OpenAssetRW(const std::string &path);
@@ -0,0 +1,107 @@
+#include "AudioThread.h"
+#include <chrono>
+#include <iostream>
+
+//how long the thread sleeps when there is nothing to play, well under a frame
+#define AUDIO_POLL_MS 1
+
+AudioThread::AudioThread() : running(false) {
+    for(int i = 0; i < GAME_EVENT_COUNT; i++) {
+        sounds[i] = NULL;
+        musics[i] = NULL;
+    }
+}
+
+AudioThread::~AudioThread() {
+    Stop();
+}
+
+void AudioThread::SetSound(GameEventType type, Mix_Chunk *sound) {
+    sounds[type] = sound;
+}
+
+void AudioThread::SetMusic(GameEventType type, Mix_Music *music) {
+    musics[type] = music;
+}
+
+void AudioThread::Start() {
+    if(running) {
+        return;
+    }
+    running = true;
+    worker = std::thread(&AudioThread::run, this);
+}
+
+void AudioThread::Stop() {
+    running = false;
+    if(worker.joinable()) {
+        worker.join();
+    }
+}
+
+void AudioThread::Post(GameEventType type, Mix_Music *music) {
+    GameEvent event;
+    event.type = type;
+    event.music = music;
+    while(!events.TryPush(event)) {
+        if(!running) {
+            std::cout << "Audio thread isn't running, dropped event " << type << std::endl;
+            return;
+        }
+        std::this_thread::yield();
+    }
+}
+
+void AudioThread::FreeMusic(Mix_Music *music) {
+    if(music == NULL) {
+        return;
+    }
+    if(!running) {
+        Mix_FreeMusic(music);
+        return;
+    }
+    Post(GAME_EVENT_FREE_MUSIC, music);
+}
+
+void AudioThread::run() {
+    while(running) {
+        GameEvent event;
+        if(events.TryPop(event)) {
+            play(event);
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(AUDIO_POLL_MS));
+        }
+    }
+    //nothing is played on the way out, but music handed over to be freed still is
+    GameEvent event;
+    while(events.TryPop(event)) {
+        if(event.type == GAME_EVENT_FREE_MUSIC) {
+            Mix_FreeMusic(event.music);
+        }
+    }
+}
+
+void AudioThread::play(const GameEvent &event) {
+    //halts it first if it is still the one playing
+    if(event.type == GAME_EVENT_FREE_MUSIC) {
+        Mix_FreeMusic(event.music);
+        return;
+    }
+    if(sounds[event.type] != NULL) {
+        Mix_PlayChannel(-1, sounds[event.type], 0);
+    }
+    if(event.type == GAME_EVENT_PAUSE) {
+        if(Mix_PlayingMusic() == 1) {
+            Mix_PauseMusic();
+        }
+    }
+    else if(event.type == GAME_EVENT_RESUME) {
+        Mix_ResumeMusic();
+    }
+    else if(event.music != NULL) {
+        Mix_PlayMusic(event.music, -1);
+    }
+    else if(musics[event.type] != NULL) {
+        Mix_PlayMusic(musics[event.type], -1);
+    }
+}
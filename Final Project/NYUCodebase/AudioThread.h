@@ -0,0 +1,62 @@
+#pragma once
+
+#include <SDL_mixer.h>
+#include <thread>
+#include <atomic>
+#include "MessageQueue.h"
+
+//things that happen in the game that something besides the simulation reacts to
+enum GameEventType {
+    GAME_EVENT_JUMP,
+    GAME_EVENT_LAND,
+    GAME_EVENT_SELECT,
+    GAME_EVENT_PAUSE,
+    GAME_EVENT_RESUME,
+    GAME_EVENT_MAIN_MENU,
+    GAME_EVENT_LEVEL_START,
+    GAME_EVENT_WIN,
+    GAME_EVENT_LOSE,
+    //not something that happened in the game, hands music that is done with to the thread that may be playing it
+    GAME_EVENT_FREE_MUSIC,
+    GAME_EVENT_COUNT
+};
+
+class GameEvent {
+    public:
+        GameEventType type;
+        //the level's own music for GAME_EVENT_LEVEL_START, the music to free for GAME_EVENT_FREE_MUSIC
+        Mix_Music *music;
+};
+
+//while it runs every SDL_mixer call that plays, pauses, resumes or frees sounds and music happens on this thread,
+//the game only posts events to it, so a jump never waits on the mixer's lock while the music decoder holds it
+//loading isn't one of them, Mix_LoadMUS_RW doesn't touch playback and runs on the level loader thread,
+//and once Stop() returns the main thread frees what is left
+class AudioThread {
+    public:
+        AudioThread();
+        ~AudioThread();
+
+        //what each event plays, set before Start(), events without one are ignored
+        void SetSound(GameEventType type, Mix_Chunk *sound);
+        void SetMusic(GameEventType type, Mix_Music *music);
+
+        void Start();
+        void Stop();
+
+        //from any thread, waits for room if the audio thread is this far behind so nothing is lost
+        void Post(GameEventType type, Mix_Music *music = NULL);
+        //from any thread, the music is freed after every event posted before it, frees it right away when the thread isn't running
+        void FreeMusic(Mix_Music *music);
+
+    private:
+        void run();
+        void play(const GameEvent &event);
+
+        Mix_Chunk *sounds[GAME_EVENT_COUNT];
+        Mix_Music *musics[GAME_EVENT_COUNT];
+
+        MPSCQueue<GameEvent, 64> events;
+        std::thread worker;
+        std::atomic<bool> running;
+};
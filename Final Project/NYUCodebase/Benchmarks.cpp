@@ -0,0 +1,216 @@
+#include "Benchmarks.h"
+#include "JobSystem.h"
+#include "Level.h"
+#include "MessageQueue.h"
+#include <SDL.h>
+#include <math.h>
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <iomanip>
+
+//every workload is run this many times and the times averaged
+#define BENCH_REPEATS 20
+
+typedef std::vector<std::function<void()>> TaskList;
+
+static double millisecondsSince(Uint64 start) {
+    return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+static double runSerial(const TaskList &tasks) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    for(size_t i = 0; i < tasks.size(); i++) {
+        tasks[i]();
+    }
+    return millisecondsSince(start);
+}
+
+//what there was before the job system, a thread started and joined for every piece of work
+static double runThreadPerTask(const TaskList &tasks) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < tasks.size(); i++) {
+        threads.push_back(std::thread(tasks[i]));
+    }
+    for(size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+    return millisecondsSince(start);
+}
+
+static double runJobs(const TaskList &tasks) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    JobCounter counter;
+    for(size_t i = 0; i < tasks.size(); i++) {
+        Jobs().Run(tasks[i], &counter);
+    }
+    Jobs().Wait(counter);
+    return millisecondsSince(start);
+}
+
+static void compare(std::ostream &out, const char *name, const TaskList &tasks) {
+    double serial = 0.0;
+    double threads = 0.0;
+    double jobs = 0.0;
+    for(int i = 0; i < BENCH_REPEATS; i++) {
+        serial += runSerial(tasks);
+        threads += runThreadPerTask(tasks);
+        jobs += runJobs(tasks);
+    }
+    out << std::fixed << std::setprecision(3) << "bench " << name << " (" << tasks.size() << " tasks): serial " << serial / BENCH_REPEATS
+    << "ms, thread per task " << threads / BENCH_REPEATS << "ms, job system " << jobs / BENCH_REPEATS << "ms" << std::endl;
+}
+
+void RunJobBenchmarks(std::ostream &out, const std::string &levelFile) {
+    out << "bench job system with " << Jobs().WorkerCount() << " workers and the calling thread" << std::endl;
+
+    //about the size of an entity step or a few rows of tiles
+    std::vector<float> results(1024);
+    TaskList small;
+    for(size_t i = 0; i < results.size(); i++) {
+        float *result = &results[i];
+        small.push_back([result, i]() {
+            float sum = 0.0f;
+            for(int n = 0; n < 2000; n++) {
+                sum += sinf((float)(i + n));
+            }
+            *result = sum;
+        });
+    }
+    compare(out, "small jobs", small);
+
+    Level level;
+    if(!level.Load(levelFile, "")) {
+        out << "bench tile meshing skipped, " << levelFile << " didn't load" << std::endl;
+        return;
+    }
+    int chunkCount = (mapHeight + TILE_CHUNK_ROWS - 1) / TILE_CHUNK_ROWS;
+    std::vector<std::vector<TileVertex>> chunks(level.layers.size() * chunkCount);
+    TaskList meshing;
+    for(size_t layer = 0; layer < level.layers.size(); layer++) {
+        for(int chunk = 0; chunk < chunkCount; chunk++) {
+            const TileLayer *tiles = &level.layers[layer];
+            std::vector<TileVertex> *vertices = &chunks[layer * chunkCount + chunk];
+            int firstRow = chunk * TILE_CHUNK_ROWS;
+            int lastRow = firstRow + TILE_CHUNK_ROWS < mapHeight ? firstRow + TILE_CHUNK_ROWS : mapHeight;
+            meshing.push_back([tiles, vertices, firstRow, lastRow]() {
+                vertices->clear();
+                tiles->BuildRows(firstRow, lastRow, *vertices);
+            });
+        }
+    }
+    compare(out, "tile meshing", meshing);
+}
+
+//what the queues replace, a deque behind a lock
+template <typename T>
+class LockedQueue {
+    public:
+        bool TryPush(const T &value) {
+            std::lock_guard<std::mutex> guard(lock);
+            items.push_back(value);
+            return true;
+        }
+        bool TryPop(T &value) {
+            std::lock_guard<std::mutex> guard(lock);
+            if(items.empty()) {
+                return false;
+            }
+            value = items.front();
+            items.pop_front();
+            return true;
+        }
+
+    private:
+        std::mutex lock;
+        std::deque<T> items;
+};
+
+class QueueMessage {
+    public:
+        int producer;
+        int sequence;
+};
+
+//producers push count messages each with their own sequence numbers, this thread pops them all
+//returns the number of messages that arrived out of order or not at all
+template <typename Queue>
+static int passMessages(Queue &queue, int producers, int count) {
+    std::vector<std::thread> threads;
+    for(int p = 0; p < producers; p++) {
+        threads.push_back(std::thread([&queue, p, count]() {
+            for(int i = 0; i < count; i++) {
+                QueueMessage message;
+                message.producer = p;
+                message.sequence = i;
+                while(!queue.TryPush(message)) {
+                    std::this_thread::yield();
+                }
+            }
+        }));
+    }
+
+    int wrong = 0;
+    std::vector<int> expected(producers, 0);
+    for(int received = 0; received < producers * count;) {
+        QueueMessage message;
+        if(!queue.TryPop(message)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if(message.producer < 0 || message.producer >= producers || message.sequence != expected[message.producer]) {
+            wrong++;
+        } else {
+            expected[message.producer]++;
+        }
+        received++;
+    }
+    for(size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+    return wrong;
+}
+
+template <typename Queue>
+static double messagesPerSecond(int producers, int count) {
+    //on the stack, new doesn't honour the cache line alignment before C++17
+    Queue queue;
+    Uint64 start = SDL_GetPerformanceCounter();
+    passMessages(queue, producers, count);
+    double seconds = millisecondsSince(start) / 1000.0;
+    return (double)(producers * count) / seconds;
+}
+
+void RunQueueBenchmarks(std::ostream &out) {
+    const int count = 1000000;
+    out << std::fixed << std::setprecision(2);
+    out << "bench one producer: SPSCQueue " << messagesPerSecond<SPSCQueue<QueueMessage, 1024>>(1, count) / 1000000.0
+    << "M messages/s, locked deque " << messagesPerSecond<LockedQueue<QueueMessage>>(1, count) / 1000000.0 << "M messages/s" << std::endl;
+    out << "bench four producers: MPSCQueue " << messagesPerSecond<MPSCQueue<QueueMessage, 1024>>(4, count / 4) / 1000000.0
+    << "M messages/s, locked deque " << messagesPerSecond<LockedQueue<QueueMessage>>(4, count / 4) / 1000000.0 << "M messages/s" << std::endl;
+}
+
+bool RunQueueStressTests(std::ostream &out) {
+    int failures = 0;
+    //small rings so the producers keep running into a full queue and the indices wrap thousands of times
+    for(int round = 0; round < 50; round++) {
+        SPSCQueue<QueueMessage, 8> single;
+        int wrong = passMessages(single, 1, 20000);
+        if(wrong > 0) {
+            out << "stress SPSCQueue round " << round << ": " << wrong << " messages wrong" << std::endl;
+            failures++;
+        }
+
+        int producers = 2 + round % 7;
+        MPSCQueue<QueueMessage, 8> multiple;
+        wrong = passMessages(multiple, producers, 20000 / producers);
+        if(wrong > 0) {
+            out << "stress MPSCQueue round " << round << " with " << producers << " producers: " << wrong << " messages wrong" << std::endl;
+            failures++;
+        }
+    }
+    out << "stress " << (failures == 0 ? "passed" : "FAILED") << std::endl;
+    return failures == 0;
+}
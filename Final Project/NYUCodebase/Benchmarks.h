@@ -0,0 +1,19 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+
+//--bench runs these instead of the game, each prints one line per workload
+
+//the same batches run one after another, on a new thread per task and through Jobs()
+//levelFile is meshed in bands of rows the way levels are when they load
+void RunJobBenchmarks(std::ostream &out, const std::string &levelFile);
+
+//messages per second through SPSCQueue and MPSCQueue next to a std::deque behind a mutex
+void RunQueueBenchmarks(std::ostream &out);
+
+//--stress hammers the queues from several threads and checks every message arrives once and in order per producer
+//the shared "NYUCodebase Stress" scheme runs it with the thread sanitizer on so the memory ordering is checked as well,
+//CI runs xcodebuild -scheme "NYUCodebase Stress" -enableThreadSanitizer YES build and then the app with --stress
+//false if anything went wrong, a race the sanitizer reports makes the process exit nonzero as well
+bool RunQueueStressTests(std::ostream &out);
@@ -0,0 +1,91 @@
+#include "DynamicResolution.h"
+#include <iostream>
+
+//native pixel art resolution is the top, pixel ratios between steps are about 1.3
+static const int resolutionLevels[][2] = { {160, 90}, {192, 108}, {224, 126}, {256, 144}, {288, 162}, {320, 180} };
+#define RESOLUTION_LEVELS (int)(sizeof(resolutionLevels) / sizeof(resolutionLevels[0]))
+
+//over this share of the budget is too slow, a step up has to be predicted under the second
+#define STEP_DOWN_LOAD 0.9f
+#define STEP_UP_LOAD 0.75f
+
+static float pixels(int level) {
+    return (float)(resolutionLevels[level][0] * resolutionLevels[level][1]);
+}
+
+DynamicResolution::DynamicResolution() : targetTime(1000.0f / 60.0f), level(RESOLUTION_LEVELS - 1), frameStart(0), useGpuTimer(false), gpuTime(0.0f), sampleCount(0), nextSample(0), sampleSum(0.0f) {}
+
+void DynamicResolution::Init(float targetMilliseconds) {
+    targetTime = targetMilliseconds;
+    useGpuTimer = GpuTimer::Supported();
+    if(useGpuTimer) {
+        gpuTimer.Init();
+    } else {
+        std::cout << "No timer queries, dynamic resolution only sees CPU time" << std::endl;
+    }
+}
+
+void DynamicResolution::Release() {
+    gpuTimer.Release();
+}
+
+void DynamicResolution::BeginFrame() {
+    frameStart = SDL_GetPerformanceCounter();
+    if(useGpuTimer) {
+        gpuTimer.Begin();
+    }
+}
+
+bool DynamicResolution::EndFrame() {
+    if(useGpuTimer) {
+        gpuTimer.End();
+        //a few frames old, which is fine for something averaged over a window anyway
+        gpuTimer.TakeResult(gpuTime);
+    }
+    float cpuTime = (float)(SDL_GetPerformanceCounter() - frameStart) * 1000.0f / (float)SDL_GetPerformanceFrequency();
+    float cost = cpuTime > gpuTime ? cpuTime : gpuTime;
+    if(sampleCount == RESOLUTION_WINDOW) {
+        sampleSum -= samples[nextSample];
+    } else {
+        sampleCount++;
+    }
+    samples[nextSample] = cost;
+    sampleSum += cost;
+    nextSample = (nextSample + 1) % RESOLUTION_WINDOW;
+    //adding and taking away floats drifts, so the sum starts over from the ring once per lap
+    if(nextSample == 0) {
+        sampleSum = 0.0f;
+        for(int i = 0; i < sampleCount; i++) {
+            sampleSum += samples[i];
+        }
+    }
+    if(sampleCount < RESOLUTION_WINDOW) {
+        return false;
+    }
+    float average = sampleSum / RESOLUTION_WINDOW;
+
+    int oldLevel = level;
+    if(average > targetTime * STEP_DOWN_LOAD && level > 0) {
+        level--;
+    }
+    //assumes the cost follows the pixel count, which is pessimistic since not all of it is fill
+    else if(level < RESOLUTION_LEVELS - 1 && average * pixels(level + 1) / pixels(level) < targetTime * STEP_UP_LOAD) {
+        level++;
+    }
+    if(level == oldLevel) {
+        return false;
+    }
+    sampleCount = 0;
+    nextSample = 0;
+    sampleSum = 0.0f;
+    std::cout << "Dynamic resolution: " << Width() << "x" << Height() << " (frames took " << average << "ms of " << targetTime << "ms)" << std::endl;
+    return true;
+}
+
+int DynamicResolution::Width() const {
+    return resolutionLevels[level][0];
+}
+
+int DynamicResolution::Height() const {
+    return resolutionLevels[level][1];
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <SDL.h>
+#include "GpuTimer.h"
+
+//the average is over this many of the latest frames, and a size has to have been drawn this long before it can change
+#define RESOLUTION_WINDOW 30
+
+//steps the low resolution target between a few sizes to hold a frame time
+//a frame costs whichever of its CPU and GPU time is longer, the two overlap
+//it only steps down when the rolling average is over budget and only steps up when the bigger size is predicted to fit with room to spare,
+//and every step empties the window since those frames were a different size, so it never flips back and forth
+class DynamicResolution {
+    public:
+        DynamicResolution();
+
+        //needs the GL context, GPU time is left out where there are no timer queries
+        void Init(float targetMilliseconds);
+        void Release();
+
+        //around all the GL work of a frame, but not the swap since that waits for vsync
+        void BeginFrame();
+        //true when the size changed
+        bool EndFrame();
+
+        int Width() const;
+        int Height() const;
+
+    private:
+        float targetTime;
+        int level;
+
+        Uint64 frameStart;
+        GpuTimer gpuTimer;
+        bool useGpuTimer;
+        float gpuTime;
+
+        //a ring of frame costs, the sum is kept as they come and go so every frame can check the average
+        float samples[RESOLUTION_WINDOW];
+        int sampleCount;
+        int nextSample;
+        float sampleSum;
+};
@@ -0,0 +1,128 @@
+#include "FileWatcher.h"
+#include <chrono>
+#include <sys/stat.h>
+#ifdef __linux__
+	#include <sys/inotify.h>
+	#include <poll.h>
+	#include <unistd.h>
+#endif
+
+#define POLL_INTERVAL_MS 250
+
+static long long modifiedTime(const std::string &path) {
+    struct stat info;
+    if(stat(path.c_str(), &info) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return info.st_mtimespec.tv_sec * 1000000000LL + info.st_mtimespec.tv_nsec;
+#elif defined(__linux__)
+    return info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+#else
+    return (long long)info.st_mtime * 1000000000LL;
+#endif
+}
+
+FileWatcher::FileWatcher() : running(false) {}
+
+FileWatcher::~FileWatcher() {
+    Stop();
+}
+
+void FileWatcher::Watch(const std::string &file, std::function<void(const std::string&)> onChange) {
+    WatchedFile watched;
+    watched.path = file;
+    size_t slash = file.find_last_of("/\\");
+    if(slash == std::string::npos) {
+        watched.directory = ".";
+        watched.name = file;
+    } else {
+        watched.directory = file.substr(0, slash);
+        watched.name = file.substr(slash + 1);
+    }
+    watched.modified = modifiedTime(file);
+    watched.onChange = onChange;
+    files.push_back(watched);
+}
+
+void FileWatcher::Start() {
+    if(running || files.empty()) {
+        return;
+    }
+    running = true;
+    worker = std::thread(&FileWatcher::run, this);
+}
+
+void FileWatcher::Stop() {
+    running = false;
+    if(worker.joinable()) {
+        worker.join();
+    }
+}
+
+void FileWatcher::run() {
+#ifdef __linux__
+    int inotify = inotify_init1(IN_NONBLOCK);
+    if(inotify >= 0) {
+        //editors usually save by writing a temp file and renaming it over the old one,
+        //so watch the directories and match names instead of watching the files themselves
+        std::vector<int> watches(files.size(), -1);
+        for(size_t i = 0; i < files.size(); i++) {
+            for(size_t j = 0; j < i; j++) {
+                if(files[j].directory == files[i].directory) {
+                    watches[i] = watches[j];
+                }
+            }
+            if(watches[i] == -1) {
+                watches[i] = inotify_add_watch(inotify, files[i].directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            }
+        }
+
+        char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+        while(running) {
+            struct pollfd waiting = {inotify, POLLIN, 0};
+            if(poll(&waiting, 1, POLL_INTERVAL_MS) <= 0) {
+                continue;
+            }
+            ssize_t length = read(inotify, buffer, sizeof(buffer));
+            if(length <= 0) {
+                continue;
+            }
+            //one save can produce several events, only reload each file once per batch
+            std::vector<bool> changed(files.size(), false);
+            for(char *ptr = buffer; ptr < buffer + length; ) {
+                const struct inotify_event *event = (const struct inotify_event*)ptr;
+                for(size_t i = 0; i < files.size(); i++) {
+                    if(event->len > 0 && watches[i] == event->wd && files[i].name == event->name) {
+                        changed[i] = true;
+                    }
+                }
+                ptr += sizeof(struct inotify_event) + event->len;
+            }
+            for(size_t i = 0; i < files.size(); i++) {
+                if(changed[i]) {
+                    files[i].onChange(files[i].path);
+                }
+            }
+        }
+        close(inotify);
+        return;
+    }
+#endif
+    runPolling();
+}
+
+void FileWatcher::runPolling() {
+    while(running) {
+        for(size_t i = 0; i < files.size(); i++) {
+            long long modified = modifiedTime(files[i].path);
+            if(modified != files[i].modified) {
+                files[i].modified = modified;
+                if(modified != 0) {
+                    files[i].onChange(files[i].path);
+                }
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <functional>
+
+//watches files on a background thread and calls back on that thread when one changes
+//uses inotify on linux and polls modification times everywhere else
+class FileWatcher {
+    public:
+        FileWatcher();
+        ~FileWatcher();
+
+        //all files have to be added before Start()
+        void Watch(const std::string &file, std::function<void(const std::string&)> onChange);
+
+        void Start();
+        void Stop();
+
+    private:
+        class WatchedFile {
+            public:
+                std::string path;
+                std::string directory;
+                std::string name;
+                long long modified;
+                std::function<void(const std::string&)> onChange;
+        };
+
+        void run();
+        void runPolling();
+
+        std::vector<WatchedFile> files;
+
+        std::thread worker;
+        std::atomic<bool> running;
+};
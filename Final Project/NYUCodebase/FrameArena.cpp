@@ -0,0 +1,72 @@
+#include "FrameArena.h"
+#include <stdlib.h>
+
+FrameArena::FrameArena() : memory(NULL), capacity(0), used(0), overflowBytes(0), growths(0) {}
+
+FrameArena::~FrameArena() {
+    Release();
+}
+
+void FrameArena::Init(size_t bytes) {
+    Release();
+    memory = (char*)malloc(bytes);
+    capacity = memory != NULL ? bytes : 0;
+}
+
+void FrameArena::Release() {
+    overflowBytes = 0;
+    Reset();
+    free(memory);
+    memory = NULL;
+    capacity = 0;
+}
+
+void FrameArena::Reset() {
+    for(size_t i = 0; i < overflow.size(); i++) {
+        free(overflow[i]);
+    }
+    overflow.clear();
+    used = 0;
+    if(overflowBytes == 0) {
+        return;
+    }
+    //one bigger block, so a frame like this one fits next time without touching the heap
+    size_t bytes = capacity + overflowBytes;
+    overflowBytes = 0;
+    growths++;
+    free(memory);
+    memory = NULL;
+    capacity = 0;
+    Init(bytes);
+}
+
+void* FrameArena::Allocate(size_t bytes, size_t alignment) {
+    //alignments are powers of two
+    size_t offset = (used + alignment - 1) & ~(alignment - 1);
+    if(memory != NULL && offset + bytes <= capacity) {
+        used = offset + bytes;
+        return memory + offset;
+    }
+    //malloc is aligned for any type
+    void *block = malloc(bytes > 0 ? bytes : 1);
+    overflow.push_back(block);
+    overflowBytes += bytes + alignment;
+    return block;
+}
+
+size_t FrameArena::Used() const {
+    return used;
+}
+
+size_t FrameArena::Capacity() const {
+    return capacity;
+}
+
+int FrameArena::Growths() const {
+    return growths;
+}
+
+FrameArena& RenderArena() {
+    static FrameArena arena;
+    return arena;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stddef.h>
+#include <string>
+#include <sstream>
+#include <vector>
+
+//bump allocator for whatever only lives until the end of the frame, like text corners and overlay strings
+//Allocate() moves a pointer along one block and Reset() at the start of the frame hands the whole block out again,
+//nothing is freed on its own, a frame that needs more than the block gets heap blocks and the next Reset() grows to fit
+//not thread safe, only the render thread allocates from RenderArena()
+class FrameArena {
+    public:
+        FrameArena();
+        ~FrameArena();
+
+        void Init(size_t bytes);
+        void Release();
+
+        void Reset();
+        void* Allocate(size_t bytes, size_t alignment);
+
+        size_t Used() const;
+        size_t Capacity() const;
+        //how many resets had to grow the block, shown on the F3 overlay
+        int Growths() const;
+
+    private:
+        char *memory;
+        size_t capacity;
+        size_t used;
+        //what the frame asked for past the block, the next block is made big enough for all of it
+        size_t overflowBytes;
+        std::vector<void*> overflow;
+        int growths;
+};
+
+FrameArena& RenderArena();
+
+//lets the standard containers allocate from a frame arena, deallocating does nothing
+//anything built with it must be gone before the arena is reset
+template <typename T>
+class FrameAllocator {
+    public:
+        typedef T value_type;
+
+        FrameAllocator() : arena(&RenderArena()) {}
+        explicit FrameAllocator(FrameArena *frameArena) : arena(frameArena) {}
+        template <typename U>
+        FrameAllocator(const FrameAllocator<U> &other) : arena(other.arena) {}
+
+        T* allocate(size_t count) {
+            return (T*)arena->Allocate(count * sizeof(T), alignof(T));
+        }
+        void deallocate(T *, size_t) {}
+
+        template <typename U>
+        bool operator==(const FrameAllocator<U> &other) const {
+            return arena == other.arena;
+        }
+        template <typename U>
+        bool operator!=(const FrameAllocator<U> &other) const {
+            return arena != other.arena;
+        }
+
+        FrameArena *arena;
+};
+
+//growing one of these leaves the old storage in the arena until the reset, so reserve what is known up front
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+typedef std::basic_string<char, std::char_traits<char>, FrameAllocator<char>> FrameString;
+typedef std::basic_ostringstream<char, std::char_traits<char>, FrameAllocator<char>> FrameStringStream;
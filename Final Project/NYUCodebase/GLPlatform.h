@@ -0,0 +1,18 @@
+#pragma once
+
+//include this instead of SDL_opengl.h so buffer, sync and vertex array functions are declared on every platform
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+	#include <SDL_opengl.h>
+#elif defined(__APPLE__)
+	#include <OpenGL/gl3.h>
+	#include <OpenGL/gl3ext.h>
+#else
+	#define GL_GLEXT_PROTOTYPES
+	#include <SDL_opengl.h>
+#endif
+
+//gl3.h only declares core enums, the legacy tilemap path still packs tile ids into luminance and alpha
+#ifndef GL_LUMINANCE_ALPHA
+	#define GL_LUMINANCE_ALPHA 0x190A
+#endif
@@ -0,0 +1,226 @@
+#include "GLState.h"
+#include "RenderStats.h"
+
+//~0 means unknown, the first call for each piece of state always goes through
+#define UNKNOWN_STATE 0xFFFFFFFFu
+
+static GLuint currentProgram = UNKNOWN_STATE;
+static GLuint activeUnit = UNKNOWN_STATE;
+static GLuint boundTextures[STATE_TEXTURE_UNITS];
+static GLuint boundArrayBuffer = UNKNOWN_STATE;
+static GLuint boundVertexArray = UNKNOWN_STATE;
+static GLuint attributeEnabled[STATE_ATTRIBUTES];
+static GLuint blendEnabled = UNKNOWN_STATE;
+static GLenum blendSource = UNKNOWN_STATE;
+static GLenum blendDestination = UNKNOWN_STATE;
+static GLuint depthTestEnabled = UNKNOWN_STATE;
+static GLuint depthWriteEnabled = UNKNOWN_STATE;
+static bool initialized = false;
+
+static GLStateCounters counters;
+
+static void initialize() {
+    if(!initialized) {
+        ResetGLState();
+    }
+}
+
+void CountStateCall(bool filtered) {
+    if(filtered) {
+        counters.filtered++;
+    } else {
+        counters.issued++;
+    }
+}
+
+GLStateCounters& GetGLStateCounters() {
+    return counters;
+}
+
+void ResetGLState() {
+    currentProgram = UNKNOWN_STATE;
+    activeUnit = UNKNOWN_STATE;
+    for(int i = 0; i < STATE_TEXTURE_UNITS; i++) {
+        boundTextures[i] = UNKNOWN_STATE;
+    }
+    boundArrayBuffer = UNKNOWN_STATE;
+    boundVertexArray = UNKNOWN_STATE;
+    for(int i = 0; i < STATE_ATTRIBUTES; i++) {
+        attributeEnabled[i] = UNKNOWN_STATE;
+    }
+    blendEnabled = UNKNOWN_STATE;
+    blendSource = UNKNOWN_STATE;
+    blendDestination = UNKNOWN_STATE;
+    depthTestEnabled = UNKNOWN_STATE;
+    depthWriteEnabled = UNKNOWN_STATE;
+    initialized = true;
+}
+
+void UseProgram(GLuint program) {
+    initialize();
+    if(currentProgram == program) {
+        CountStateCall(true);
+        return;
+    }
+    glUseProgram(program);
+    currentProgram = program;
+    CountStateCall(false);
+    CountProgramSwitch();
+}
+
+void ActiveTexture(int unit) {
+    initialize();
+    if(activeUnit == (GLuint)unit) {
+        CountStateCall(true);
+        return;
+    }
+    glActiveTexture(GL_TEXTURE0 + unit);
+    activeUnit = unit;
+    CountStateCall(false);
+}
+
+void BindTexture(GLuint texture) {
+    initialize();
+    if(activeUnit == UNKNOWN_STATE) {
+        ActiveTexture(0);
+    }
+    if(activeUnit < STATE_TEXTURE_UNITS && boundTextures[activeUnit] == texture) {
+        CountStateCall(true);
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if(activeUnit < STATE_TEXTURE_UNITS) {
+        boundTextures[activeUnit] = texture;
+    }
+    CountStateCall(false);
+    CountTextureBind();
+}
+
+void BindArrayBuffer(GLuint buffer) {
+    initialize();
+    if(boundArrayBuffer == buffer) {
+        CountStateCall(true);
+        return;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    boundArrayBuffer = buffer;
+    CountStateCall(false);
+}
+
+void BindVertexArray(GLuint vertexArray) {
+    initialize();
+    if(boundVertexArray == vertexArray) {
+        CountStateCall(true);
+        return;
+    }
+    glBindVertexArray(vertexArray);
+    boundVertexArray = vertexArray;
+    CountStateCall(false);
+}
+
+void SetAttributeEnabled(GLuint attribute, bool enabled) {
+    initialize();
+    //boundVertexArray is unknown until the first bind, which only happens when the context has vertex arrays at all
+    bool defaultVertexArray = (boundVertexArray == 0 || boundVertexArray == UNKNOWN_STATE);
+    if(defaultVertexArray && attribute < STATE_ATTRIBUTES && attributeEnabled[attribute] == (GLuint)enabled) {
+        CountStateCall(true);
+        return;
+    }
+    if(enabled) {
+        glEnableVertexAttribArray(attribute);
+    } else {
+        glDisableVertexAttribArray(attribute);
+    }
+    if(defaultVertexArray && attribute < STATE_ATTRIBUTES) {
+        attributeEnabled[attribute] = enabled;
+    }
+    CountStateCall(false);
+}
+
+void SetBlend(bool enabled) {
+    initialize();
+    if(blendEnabled == (GLuint)enabled) {
+        CountStateCall(true);
+        return;
+    }
+    if(enabled) {
+        glEnable(GL_BLEND);
+    } else {
+        glDisable(GL_BLEND);
+    }
+    blendEnabled = enabled;
+    CountStateCall(false);
+}
+
+void SetBlendFunc(GLenum source, GLenum destination) {
+    initialize();
+    if(blendSource == source && blendDestination == destination) {
+        CountStateCall(true);
+        return;
+    }
+    glBlendFunc(source, destination);
+    blendSource = source;
+    blendDestination = destination;
+    CountStateCall(false);
+}
+
+void SetDepthTest(bool enabled) {
+    initialize();
+    if(depthTestEnabled == (GLuint)enabled) {
+        CountStateCall(true);
+        return;
+    }
+    if(enabled) {
+        glEnable(GL_DEPTH_TEST);
+    } else {
+        glDisable(GL_DEPTH_TEST);
+    }
+    depthTestEnabled = enabled;
+    CountStateCall(false);
+}
+
+void SetDepthWrite(bool enabled) {
+    initialize();
+    if(depthWriteEnabled == (GLuint)enabled) {
+        CountStateCall(true);
+        return;
+    }
+    glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    depthWriteEnabled = enabled;
+    CountStateCall(false);
+}
+
+//GL unbinds deleted objects, and their names can be handed out again, so the cache has to forget them
+void DeleteProgram(GLuint program) {
+    initialize();
+    glDeleteProgram(program);
+    if(currentProgram == program) {
+        currentProgram = UNKNOWN_STATE;
+    }
+}
+
+void DeleteTexture(GLuint texture) {
+    initialize();
+    glDeleteTextures(1, &texture);
+    for(int i = 0; i < STATE_TEXTURE_UNITS; i++) {
+        if(boundTextures[i] == texture) {
+            boundTextures[i] = 0;
+        }
+    }
+}
+
+void DeleteBuffer(GLuint buffer) {
+    initialize();
+    glDeleteBuffers(1, &buffer);
+    if(boundArrayBuffer == buffer) {
+        boundArrayBuffer = 0;
+    }
+}
+
+void DeleteVertexArray(GLuint vertexArray) {
+    initialize();
+    glDeleteVertexArrays(1, &vertexArray);
+    if(boundVertexArray == vertexArray) {
+        boundVertexArray = 0;
+    }
+}
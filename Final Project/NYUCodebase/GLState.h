@@ -0,0 +1,42 @@
+#pragma once
+
+#include "GLPlatform.h"
+
+#define STATE_TEXTURE_UNITS 8
+#define STATE_ATTRIBUTES 8
+
+//how many state changes went to the driver and how many were dropped because nothing would have changed
+class GLStateCounters {
+    public:
+        GLStateCounters() : issued(0), filtered(0) {}
+
+        int issued;
+        int filtered;
+};
+
+//a thin cache in front of the state calls that get repeated the most, a call that wouldn't change anything never reaches the driver
+//everything that binds or deletes programs, textures, buffers or vertex arrays has to go through here or the cache goes stale
+void UseProgram(GLuint program);
+void ActiveTexture(int unit);
+//binds to the active unit
+void BindTexture(GLuint texture);
+void BindArrayBuffer(GLuint buffer);
+void BindVertexArray(GLuint vertexArray);
+//attribute arrays are remembered for the default vertex array only, inside a vertex array object they go straight through
+void SetAttributeEnabled(GLuint attribute, bool enabled);
+void SetBlend(bool enabled);
+void SetBlendFunc(GLenum source, GLenum destination);
+void SetDepthTest(bool enabled);
+void SetDepthWrite(bool enabled);
+
+void DeleteProgram(GLuint program);
+void DeleteTexture(GLuint texture);
+void DeleteBuffer(GLuint buffer);
+void DeleteVertexArray(GLuint vertexArray);
+
+//forgets everything, for when something changed state behind the cache's back
+void ResetGLState();
+
+//uniform shadows live with the program, they report here so the counts cover everything
+void CountStateCall(bool filtered);
+GLStateCounters& GetGLStateCounters();
@@ -0,0 +1,98 @@
+#include "GoldenImage.h"
+#include "GLPlatform.h"
+#include <SDL.h>
+#include <SDL_image.h>
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include "stb_image.h"
+
+GoldenImage::GoldenImage() : width(0), height(0) {}
+
+void GoldenImage::ReadFramebuffer(int imageWidth, int imageHeight) {
+    width = imageWidth;
+    height = imageHeight;
+    pixels.resize(width * height * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+
+    //GL gives the bottom row first
+    std::vector<unsigned char> row(width * 4);
+    for(int y = 0; y < height / 2; y++) {
+        unsigned char *top = &pixels[y * width * 4];
+        unsigned char *bottom = &pixels[(height - 1 - y) * width * 4];
+        memcpy(&row[0], top, width * 4);
+        memcpy(top, bottom, width * 4);
+        memcpy(bottom, &row[0], width * 4);
+    }
+}
+
+bool GoldenImage::Load(const std::string &file) {
+    int comp;
+    unsigned char *image = stbi_load(file.c_str(), &width, &height, &comp, STBI_rgb_alpha);
+    if(image == NULL) {
+        width = height = 0;
+        pixels.clear();
+        return false;
+    }
+    pixels.assign(image, image + width * height * 4);
+    stbi_image_free(image);
+    return true;
+}
+
+bool GoldenImage::Save(const std::string &file) const {
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormatFrom((void*)&pixels[0], width, height, 32, width * 4, SDL_PIXELFORMAT_RGBA32);
+    if(surface == NULL) {
+        std::cout << "Unable to save " << file << ": " << SDL_GetError() << std::endl;
+        return false;
+    }
+    bool saved = IMG_SavePNG(surface, file.c_str()) == 0;
+    if(!saved) {
+        std::cout << "Unable to save " << file << ": " << SDL_GetError() << std::endl;
+    }
+    SDL_FreeSurface(surface);
+    return saved;
+}
+
+GoldenDifference::GoldenDifference() : sizeMatches(false), differentPixels(0), largestChannelDifference(0) {}
+
+GoldenDifference CompareGoldenImages(const GoldenImage &image, const GoldenImage &reference, int channelTolerance, GoldenImage *difference) {
+    GoldenDifference result;
+    result.sizeMatches = image.width == reference.width && image.height == reference.height;
+    if(!result.sizeMatches) {
+        result.differentPixels = image.width * image.height;
+        return result;
+    }
+    if(difference != NULL) {
+        difference->width = image.width;
+        difference->height = image.height;
+        difference->pixels.resize(image.pixels.size());
+    }
+
+    for(size_t i = 0; i < image.pixels.size(); i += 4) {
+        int largest = 0;
+        for(int c = 0; c < 4; c++) {
+            int channel = abs((int)image.pixels[i + c] - (int)reference.pixels[i + c]);
+            if(channel > largest) {
+                largest = channel;
+            }
+        }
+        if(largest > result.largestChannelDifference) {
+            result.largestChannelDifference = largest;
+        }
+        bool different = largest > channelTolerance;
+        if(different) {
+            result.differentPixels++;
+        }
+
+        if(difference != NULL) {
+            unsigned char *out = &difference->pixels[i];
+            unsigned char grey = (unsigned char)((reference.pixels[i] + reference.pixels[i + 1] + reference.pixels[i + 2]) / 6);
+            out[0] = different ? 255 : grey;
+            out[1] = different ? 0 : grey;
+            out[2] = different ? 0 : grey;
+            out[3] = 255;
+        }
+    }
+    return result;
+}
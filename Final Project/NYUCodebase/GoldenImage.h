@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+//an RGBA picture with its top row first, the same layout as the PNGs it is compared against
+class GoldenImage {
+    public:
+        GoldenImage();
+
+        //copies the bottom left corner of whatever framebuffer is bound, needs the GL context
+        void ReadFramebuffer(int imageWidth, int imageHeight);
+
+        bool Load(const std::string &file);
+        bool Save(const std::string &file) const;
+
+        int width;
+        int height;
+        std::vector<unsigned char> pixels;
+};
+
+//how far a render is from its reference
+class GoldenDifference {
+    public:
+        GoldenDifference();
+
+        bool sizeMatches;
+        //pixels with a channel more than the tolerance apart
+        int differentPixels;
+        int largestChannelDifference;
+};
+
+//the difference image is the reference in grey with every pixel that failed in red, pass NULL to skip it
+GoldenDifference CompareGoldenImages(const GoldenImage &image, const GoldenImage &reference, int channelTolerance, GoldenImage *difference);
@@ -0,0 +1,155 @@
+#include "GpuProfiler.h"
+
+static const char *passNames[GPU_PASS_COUNT] = { "background", "map", "entities", "text", "post" };
+
+GpuProfiler::GpuProfiler() : frameNumber(-1), frameTime(0.0f), enabled(false), frameCount(0), current(0), passOpen(false) {
+    for(int i = 0; i < GPU_PASS_COUNT; i++) {
+        passTimes[i] = 0.0f;
+    }
+    for(int i = 0; i < GPU_TIMER_FRAMES; i++) {
+        frames[i].number = -1;
+        frames[i].issued = false;
+        frames[i].start = 0;
+        frames[i].end = 0;
+    }
+}
+
+const char* GpuProfiler::PassName(GpuPass pass) {
+    return passNames[pass];
+}
+
+void GpuProfiler::Init() {
+    enabled = GpuTimer::Supported();
+}
+
+void GpuProfiler::Release() {
+    if(!allQueries.empty()) {
+        glDeleteQueries((GLsizei)allQueries.size(), allQueries.data());
+    }
+    allQueries.clear();
+    freeQueries.clear();
+    for(int i = 0; i < GPU_TIMER_FRAMES; i++) {
+        frames[i].issued = false;
+        frames[i].markers.clear();
+    }
+    enabled = false;
+}
+
+bool GpuProfiler::Enabled() const {
+    return enabled;
+}
+
+//queries are made the first time a frame needs that many and recycled after that
+GLuint GpuProfiler::query() {
+    if(freeQueries.empty()) {
+        GLuint made;
+        glGenQueries(1, &made);
+        allQueries.push_back(made);
+        return made;
+    }
+    GLuint reused = freeQueries.back();
+    freeQueries.pop_back();
+    return reused;
+}
+
+//a frame is read back whole once its last stamp is there, older frames come first
+void GpuProfiler::collect() {
+    //called right after current moved on, so current is the oldest slot
+    for(int i = 0; i < GPU_TIMER_FRAMES; i++) {
+        Frame &frame = frames[(current + i) % GPU_TIMER_FRAMES];
+        if(!frame.issued) {
+            continue;
+        }
+        GLint available = 0;
+        glGetQueryObjectiv(frame.end, GL_QUERY_RESULT_AVAILABLE, &available);
+        if(!available) {
+            continue;
+        }
+
+        GLuint64 frameStart = 0;
+        GLuint64 frameEnd = 0;
+        glGetQueryObjectui64v(frame.start, GL_QUERY_RESULT, &frameStart);
+        glGetQueryObjectui64v(frame.end, GL_QUERY_RESULT, &frameEnd);
+        frameTime = (float)(frameEnd - frameStart) / 1000000.0f;
+        for(int pass = 0; pass < GPU_PASS_COUNT; pass++) {
+            passTimes[pass] = 0.0f;
+        }
+        spans.clear();
+        for(size_t m = 0; m < frame.markers.size(); m++) {
+            GLuint64 start = 0;
+            GLuint64 end = 0;
+            glGetQueryObjectui64v(frame.markers[m].start, GL_QUERY_RESULT, &start);
+            glGetQueryObjectui64v(frame.markers[m].end, GL_QUERY_RESULT, &end);
+            GpuSpan span;
+            span.pass = frame.markers[m].pass;
+            span.start = (float)(start - frameStart) / 1000000.0f;
+            span.duration = (float)(end - start) / 1000000.0f;
+            passTimes[span.pass] += span.duration;
+            spans.push_back(span);
+
+            freeQueries.push_back(frame.markers[m].start);
+            freeQueries.push_back(frame.markers[m].end);
+        }
+        freeQueries.push_back(frame.start);
+        freeQueries.push_back(frame.end);
+        frame.markers.clear();
+        frame.issued = false;
+        frameNumber = frame.number;
+    }
+}
+
+void GpuProfiler::BeginFrame() {
+    if(!enabled) {
+        return;
+    }
+    current = (current + 1) % GPU_TIMER_FRAMES;
+    collect();
+    Frame &frame = frames[current];
+    //the GPU is more than GPU_TIMER_FRAMES behind, the old results are given up rather than waited for
+    if(frame.issued) {
+        for(size_t m = 0; m < frame.markers.size(); m++) {
+            freeQueries.push_back(frame.markers[m].start);
+            freeQueries.push_back(frame.markers[m].end);
+        }
+        freeQueries.push_back(frame.start);
+        freeQueries.push_back(frame.end);
+        frame.markers.clear();
+        frame.issued = false;
+    }
+    frame.number = frameCount++;
+    frame.start = query();
+    frame.end = query();
+    glQueryCounter(frame.start, GL_TIMESTAMP);
+    passOpen = false;
+}
+
+void GpuProfiler::Begin(GpuPass pass) {
+    if(!enabled) {
+        return;
+    }
+    End();
+    Marker marker;
+    marker.pass = pass;
+    marker.start = query();
+    marker.end = query();
+    glQueryCounter(marker.start, GL_TIMESTAMP);
+    frames[current].markers.push_back(marker);
+    passOpen = true;
+}
+
+void GpuProfiler::End() {
+    if(!enabled || !passOpen) {
+        return;
+    }
+    glQueryCounter(frames[current].markers.back().end, GL_TIMESTAMP);
+    passOpen = false;
+}
+
+void GpuProfiler::EndFrame() {
+    if(!enabled) {
+        return;
+    }
+    End();
+    glQueryCounter(frames[current].end, GL_TIMESTAMP);
+    frames[current].issued = true;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "GLPlatform.h"
+#include "GpuTimer.h"
+#include <stddef.h>
+#include <vector>
+
+enum GpuPass { GPU_PASS_BACKGROUND, GPU_PASS_MAP, GPU_PASS_ENTITIES, GPU_PASS_TEXT, GPU_PASS_POST };
+#define GPU_PASS_COUNT 5
+
+//one span of GPU time, times are in milliseconds from the start of its frame
+class GpuSpan {
+    public:
+        GpuPass pass;
+        float start;
+        float duration;
+};
+
+//GPU time per pass from GL_TIMESTAMP queries, with a set of queries per frame in flight like GpuTimer
+//a pass can be entered several times a frame, the render queue interleaves them between its alpha passes, so its time is the sum
+class GpuProfiler {
+    public:
+        GpuProfiler();
+
+        //needs the GL context, does nothing where GpuTimer::Supported() is false
+        void Init();
+        void Release();
+        bool Enabled() const;
+
+        void BeginFrame();
+        //ends whatever pass was open, so passes can simply follow each other
+        void Begin(GpuPass pass);
+        void End();
+        void EndFrame();
+
+        //the newest frame the GPU has finished, frameNumber is what BeginFrame() was on for it and -1 before there is one
+        int frameNumber;
+        float passTimes[GPU_PASS_COUNT];
+        float frameTime;
+        std::vector<GpuSpan> spans;
+
+        static const char* PassName(GpuPass pass);
+
+    private:
+        class Marker {
+            public:
+                GpuPass pass;
+                GLuint start;
+                GLuint end;
+        };
+
+        class Frame {
+            public:
+                int number;
+                bool issued;
+                GLuint start;
+                GLuint end;
+                std::vector<Marker> markers;
+        };
+
+        GLuint query();
+        void collect();
+
+        bool enabled;
+        int frameCount;
+        int current;
+        bool passOpen;
+        Frame frames[GPU_TIMER_FRAMES];
+        std::vector<GLuint> freeQueries;
+        std::vector<GLuint> allQueries;
+};
@@ -0,0 +1,85 @@
+#include "GpuTimer.h"
+#include "RenderBackend.h"
+#include <SDL.h>
+
+GpuTimer::GpuTimer() : dropped(0), next(0), latest(0.0f), fresh(false) {
+    for(int i = 0; i < GPU_TIMER_FRAMES; i++) {
+        startQueries[i] = 0;
+        endQueries[i] = 0;
+        issued[i] = false;
+    }
+}
+
+bool GpuTimer::Supported() {
+    return CurrentRenderBackend() == RENDER_CORE || SDL_GL_ExtensionSupported("GL_ARB_timer_query");
+}
+
+void GpuTimer::Init() {
+    glGenQueries(GPU_TIMER_FRAMES, startQueries);
+    glGenQueries(GPU_TIMER_FRAMES, endQueries);
+}
+
+void GpuTimer::Release() {
+    if(startQueries[0] != 0) {
+        glDeleteQueries(GPU_TIMER_FRAMES, startQueries);
+        glDeleteQueries(GPU_TIMER_FRAMES, endQueries);
+        for(int i = 0; i < GPU_TIMER_FRAMES; i++) {
+            startQueries[i] = 0;
+            endQueries[i] = 0;
+            issued[i] = false;
+        }
+    }
+}
+
+//reads back every slot the GPU is done with, oldest first so latest ends up the newest
+void GpuTimer::collect() {
+    for(int i = 0; i < GPU_TIMER_FRAMES; i++) {
+        int slot = (next + i) % GPU_TIMER_FRAMES;
+        if(!issued[slot]) {
+            continue;
+        }
+        //the end stamp comes after the start, once it is there both are
+        GLint available = 0;
+        glGetQueryObjectiv(endQueries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if(!available) {
+            continue;
+        }
+        GLuint64 start = 0;
+        GLuint64 end = 0;
+        glGetQueryObjectui64v(startQueries[slot], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(endQueries[slot], GL_QUERY_RESULT, &end);
+        latest = (float)(end - start) / 1000000.0f;
+        fresh = true;
+        issued[slot] = false;
+    }
+}
+
+void GpuTimer::Begin() {
+    if(startQueries[0] == 0) {
+        return;
+    }
+    collect();
+    if(issued[next]) {
+        dropped++;
+        issued[next] = false;
+    }
+    glQueryCounter(startQueries[next], GL_TIMESTAMP);
+}
+
+void GpuTimer::End() {
+    if(startQueries[0] == 0) {
+        return;
+    }
+    glQueryCounter(endQueries[next], GL_TIMESTAMP);
+    issued[next] = true;
+    next = (next + 1) % GPU_TIMER_FRAMES;
+}
+
+bool GpuTimer::TakeResult(float &milliseconds) {
+    if(!fresh) {
+        return false;
+    }
+    milliseconds = latest;
+    fresh = false;
+    return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "GLPlatform.h"
+
+//frames the GPU may be behind, a result is read back this many frames after it was asked for
+#define GPU_TIMER_FRAMES 3
+
+//times a range of GL commands with a pair of GL_TIMESTAMP queries
+//each frame in flight has its own pair so reading a result never waits on the GPU,
+//and timestamps unlike GL_TIME_ELAPSED can nest inside other timers
+class GpuTimer {
+    public:
+        GpuTimer();
+
+        //timer queries are core in 3.3 and GL_ARB_timer_query before that
+        static bool Supported();
+
+        //needs the GL context
+        void Init();
+        void Release();
+
+        void Begin();
+        void End();
+
+        //true once per finished measurement, which is GPU_TIMER_FRAMES frames old at most
+        bool TakeResult(float &milliseconds);
+
+        //results that were still pending when their slot came round again
+        int dropped;
+
+    private:
+        void collect();
+
+        GLuint startQueries[GPU_TIMER_FRAMES];
+        GLuint endQueries[GPU_TIMER_FRAMES];
+        bool issued[GPU_TIMER_FRAMES];
+        int next;
+
+        float latest;
+        bool fresh;
+};
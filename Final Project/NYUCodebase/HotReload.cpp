@@ -0,0 +1,116 @@
+#include "HotReload.h"
+#include "TextureCache.h"
+
+static bool readFile(const std::string &file, std::string &contents) {
+    std::ifstream infile(file);
+    if(infile.fail()) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << infile.rdbuf();
+    contents = buffer.str();
+    return true;
+}
+
+HotReload::HotReload(TextureUploader *textureUploader) : uploader(textureUploader), levels(NULL) {}
+
+HotReload::~HotReload() {
+    watcher.Stop();
+    for(size_t i = 0; i < textures.size(); i++) {
+        FreeCachedImage(textures[i].image);
+    }
+    for(size_t i = 0; i < levelTiles.size(); i++) {
+        delete levelTiles[i];
+    }
+}
+
+void HotReload::WatchTexture(const std::string &file, GLuint texture) {
+    watcher.Watch(file, [this, texture](const std::string &path) {
+        PendingTexture pending;
+        pending.texture = texture;
+        //the edit is in the loose file, the pack only has what it was built from
+        pending.image = LoadCachedImage(path, &pending.width, &pending.height, true);
+        if(pending.image == NULL) {
+            //most likely caught the file halfway through being saved, the next event will retry
+            std::cout << "Hot reload: unable to load image " << path << std::endl;
+            return;
+        }
+        pending.alpha.Build(pending.image, pending.width, pending.height);
+        std::lock_guard<std::mutex> guard(pendingLock);
+        textures.push_back(pending);
+    });
+}
+
+void HotReload::WatchShader(const std::string &vertexFile, const std::string &fragmentFile, ShaderProgram *program) {
+    std::function<void(const std::string&)> onChange = [this, vertexFile, fragmentFile, program](const std::string &path) {
+        PendingShader pending;
+        pending.program = program;
+        if(!readFile(vertexFile, pending.vertexSource) || !readFile(fragmentFile, pending.fragmentSource)) {
+            std::cout << "Hot reload: unable to read shader " << path << std::endl;
+            return;
+        }
+        std::lock_guard<std::mutex> guard(pendingLock);
+        shaders.push_back(pending);
+    };
+    watcher.Watch(vertexFile, onChange);
+    watcher.Watch(fragmentFile, onChange);
+}
+
+void HotReload::WatchLevels(LevelManager *levelManager) {
+    levels = levelManager;
+    for(int i = 0; i < levels->LevelCount(); i++) {
+        watcher.Watch(levels->LevelFile(i), [this](const std::string &path) {
+            //only the tiles are reloaded, entities and music stay as they are
+            Level *level = new Level();
+            if(!level->Load(path, "", true)) {
+                delete level;
+                return;
+            }
+            std::lock_guard<std::mutex> guard(pendingLock);
+            levelTiles.push_back(level);
+        });
+    }
+}
+
+void HotReload::Start() {
+    watcher.Start();
+}
+
+void HotReload::Apply() {
+    std::vector<PendingTexture> readyTextures;
+    std::vector<PendingShader> readyShaders;
+    {
+        std::lock_guard<std::mutex> guard(pendingLock);
+        readyTextures.swap(textures);
+        readyShaders.swap(shaders);
+    }
+
+    //uploading into the same texture name keeps every SheetSprite pointing at it valid,
+    //the uploader spreads the rows over the next few frames
+    for(size_t i = 0; i < readyTextures.size(); i++) {
+        uploader->QueueInto(readyTextures[i].texture, readyTextures[i].image, readyTextures[i].width, readyTextures[i].height);
+        //sprites pick up the new classes right away, tile meshes when they are rebuilt
+        SetTextureAlpha(readyTextures[i].texture, readyTextures[i].alpha);
+    }
+
+    for(size_t i = 0; i < readyShaders.size(); i++) {
+        readyShaders[i].program->Reload(readyShaders[i].vertexSource, readyShaders[i].fragmentSource);
+    }
+
+}
+
+void HotReload::ApplyLevels(std::mutex &simulationLock) {
+    std::vector<Level*> readyLevels;
+    {
+        std::lock_guard<std::mutex> guard(pendingLock);
+        readyLevels.swap(levelTiles);
+    }
+    if(readyLevels.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> pause(simulationLock);
+    for(size_t i = 0; i < readyLevels.size(); i++) {
+        levels->ReloadTiles(readyLevels[i]);
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "GLPlatform.h"
+#include <string>
+#include <vector>
+#include <mutex>
+#include "FileWatcher.h"
+#include "ShaderProgram.h"
+#include "LevelManager.h"
+#include "TextureUploader.h"
+#include "TextureAlpha.h"
+
+//reloads levels, shaders and textures while the game is running
+//files are read and decoded on the watcher thread, Apply() does the GL work on the main thread
+class HotReload {
+    public:
+        HotReload(TextureUploader *uploader);
+        ~HotReload();
+
+        void WatchTexture(const std::string &file, GLuint texture);
+        void WatchShader(const std::string &vertexFile, const std::string &fragmentFile, ShaderProgram *program);
+        void WatchLevels(LevelManager *levels);
+
+        void Start();
+
+        //call once per frame from the thread that owns the GL context
+        void Apply();
+        //levels are also read by the simulation, the lock is held while their tiles are swapped in
+        //only taken when a level has actually changed
+        void ApplyLevels(std::mutex &simulationLock);
+
+    private:
+        class PendingTexture {
+            public:
+                GLuint texture;
+                unsigned char *image;
+                int width;
+                int height;
+                AlphaMap alpha;
+        };
+
+        class PendingShader {
+            public:
+                ShaderProgram *program;
+                std::string vertexSource;
+                std::string fragmentSource;
+        };
+
+        FileWatcher watcher;
+        TextureUploader *uploader;
+        LevelManager *levels;
+
+        std::mutex pendingLock;
+        std::vector<PendingTexture> textures;
+        std::vector<PendingShader> shaders;
+        std::vector<Level*> levelTiles;
+};
@@ -0,0 +1,203 @@
+#include "JobSystem.h"
+
+//which deque the thread owns, threads that aren't workers push round robin and only steal
+static thread_local int currentWorker = -1;
+
+JobCounter::JobCounter() : remaining(0) {}
+
+bool JobCounter::Done() const {
+    return remaining.load() == 0;
+}
+
+JobSystem::JobSystem() : running(false), nextWorker(0), queued(0) {}
+
+JobSystem::~JobSystem() {
+    Stop();
+    for(size_t i = 0; i < workers.size(); i++) {
+        delete workers[i];
+    }
+}
+
+void JobSystem::Start(int workerCount) {
+    Stop();
+    for(size_t i = 0; i < workers.size(); i++) {
+        delete workers[i];
+    }
+    workers.clear();
+    if(workerCount <= 0) {
+        workerCount = (int)std::thread::hardware_concurrency() - 1;
+    }
+    if(workerCount < 0) {
+        workerCount = 0;
+    }
+    int dequeCount = workerCount > 0 ? workerCount : 1;
+    for(int i = 0; i < dequeCount; i++) {
+        workers.push_back(new Worker());
+    }
+    running = true;
+    for(int i = 0; i < workerCount; i++) {
+        threads.push_back(std::thread(&JobSystem::run, this, i));
+    }
+}
+
+void JobSystem::Stop() {
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        running = false;
+    }
+    wake.notify_all();
+    for(size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+    threads.clear();
+}
+
+int JobSystem::WorkerCount() const {
+    return (int)threads.size();
+}
+
+void JobSystem::Run(const Job &job, JobCounter *counter, JobCounter *dependency) {
+    if(counter != NULL) {
+        counter->remaining++;
+    }
+    Job counted = [this, job, counter]() {
+        job();
+        finish(counter);
+    };
+    //not started, everything runs right here
+    if(workers.empty()) {
+        if(dependency != NULL && !dependency->Done()) {
+            Wait(*dependency);
+        }
+        counted();
+        return;
+    }
+
+    if(dependency != NULL) {
+        std::lock_guard<std::mutex> guard(dependency->waitingLock);
+        if(!dependency->Done()) {
+            dependency->waiting.push_back(counted);
+            return;
+        }
+    }
+    push(counted);
+}
+
+void JobSystem::push(const Job &job) {
+    int index = currentWorker;
+    if(index < 0) {
+        index = nextWorker++ % (int)workers.size();
+    }
+    {
+        std::lock_guard<std::mutex> guard(workers[index]->lock);
+        workers[index]->jobs.push_back(job);
+    }
+    queued++;
+    //taking the lock means a worker about to sleep either sees the job or is already waiting for this
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+    }
+    wake.notify_one();
+}
+
+bool JobSystem::take(int self, Job &job) {
+    if(self >= 0) {
+        Worker *own = workers[self];
+        std::lock_guard<std::mutex> guard(own->lock);
+        if(!own->jobs.empty()) {
+            job = own->jobs.back();
+            own->jobs.pop_back();
+            queued--;
+            return true;
+        }
+    }
+    int count = (int)workers.size();
+    for(int i = 1; i <= count; i++) {
+        Worker *victim = workers[(self + i + count) % count];
+        std::lock_guard<std::mutex> guard(victim->lock);
+        if(!victim->jobs.empty()) {
+            job = victim->jobs.front();
+            victim->jobs.pop_front();
+            queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::finish(JobCounter *counter) {
+    if(counter == NULL) {
+        return;
+    }
+    std::vector<Job> ready;
+    {
+        //counted down under the lock, Wait() takes it too so the counter isn't freed while this still holds it
+        std::lock_guard<std::mutex> guard(counter->waitingLock);
+        if(--counter->remaining > 0) {
+            return;
+        }
+        ready.swap(counter->waiting);
+    }
+    for(size_t i = 0; i < ready.size(); i++) {
+        push(ready[i]);
+    }
+}
+
+void JobSystem::Wait(JobCounter &counter) {
+    while(!counter.Done()) {
+        Job job;
+        if(!workers.empty() && take(currentWorker, job)) {
+            job();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    std::lock_guard<std::mutex> guard(counter.waitingLock);
+}
+
+void JobSystem::ParallelFor(int begin, int end, int grain, const std::function<void(int, int)> &body) {
+    int count = end - begin;
+    if(count <= 0) {
+        return;
+    }
+    if(grain < 1) {
+        grain = 1;
+    }
+    //a few pieces per thread is enough to even out uneven pieces, more is just overhead
+    int pieces = (count + grain - 1) / grain;
+    int mostPieces = (WorkerCount() + 1) * 4;
+    if(pieces > mostPieces) {
+        pieces = mostPieces;
+    }
+    if(pieces <= 1 || threads.empty()) {
+        body(begin, end);
+        return;
+    }
+
+    JobCounter counter;
+    for(int i = 1; i < pieces; i++) {
+        int first = begin + (int)((long long)count * i / pieces);
+        int last = begin + (int)((long long)count * (i + 1) / pieces);
+        Run([&body, first, last]() { body(first, last); }, &counter);
+    }
+    body(begin, begin + (int)((long long)count / pieces));
+    Wait(counter);
+}
+
+void JobSystem::run(int self) {
+    currentWorker = self;
+    while(running) {
+        Job job;
+        if(take(self, job)) {
+            job();
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(sleepLock);
+        wake.wait(guard, [this]() { return queued > 0 || !running; });
+    }
+}
+
+JobSystem& Jobs() {
+    static JobSystem jobs;
+    return jobs;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+typedef std::function<void()> Job;
+
+//how many jobs of a batch are still queued or running, the jobs added with it as their dependency start when it reaches zero
+class JobCounter {
+    public:
+        JobCounter();
+
+        bool Done() const;
+
+    private:
+        friend class JobSystem;
+
+        std::atomic<int> remaining;
+        std::mutex waitingLock;
+        std::vector<Job> waiting;
+};
+
+//a fixed set of worker threads, each with its own deque of jobs
+//a worker runs its newest job first and when it runs out steals the oldest job from another worker,
+//so a job that spawns more keeps them on the same core and idle workers take the big untouched pieces
+//any thread can add jobs and any thread waiting on a counter runs jobs until it is done, so nothing blocks a worker
+class JobSystem {
+    public:
+        JobSystem();
+        ~JobSystem();
+
+        //0 workers is one less than the hardware has, the thread that waits is the last one
+        void Start(int workers = 0);
+        //joins the workers, jobs added after this run on whichever thread waits for them
+        void Stop();
+        int WorkerCount() const;
+
+        //counter and dependency can be NULL, the job only starts once dependency is done
+        void Run(const Job &job, JobCounter *counter, JobCounter *dependency = NULL);
+        //returns when the counter is done, running other jobs in the meantime
+        void Wait(JobCounter &counter);
+
+        //calls body(first, last) over [begin, end) in pieces of at least grain and waits for all of them
+        //the calling thread does the first piece, anything that fits in one piece never leaves it
+        void ParallelFor(int begin, int end, int grain, const std::function<void(int, int)> &body);
+
+    private:
+        class Worker {
+            public:
+                std::mutex lock;
+                std::deque<Job> jobs;
+        };
+
+        void push(const Job &job);
+        bool take(int self, Job &job);
+        void finish(JobCounter *counter);
+        void run(int self);
+
+        //one more deque than threads when there are none, so jobs still have somewhere to wait for Wait() to run them
+        std::vector<Worker*> workers;
+        std::vector<std::thread> threads;
+        std::atomic<bool> running;
+        std::atomic<int> nextWorker;
+
+        //workers with nothing to steal sleep here until a job is added
+        std::mutex sleepLock;
+        std::condition_variable wake;
+        std::atomic<int> queued;
+};
+
+//the one every part of the game shares, started in main
+JobSystem& Jobs();
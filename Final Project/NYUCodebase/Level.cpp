@@ -0,0 +1,427 @@
+#include "Level.h"
+#include "JobSystem.h"
+#include "GLState.h"
+#include "AssetPack.h"
+#include "RenderBackend.h"
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <algorithm>
+
+Level::Level() : music(NULL) {
+    for(int y = 0; y < mapHeight; y++) {
+        for(int x = 0; x < mapWidth; x++) {
+            levelData[y][x] = 0;
+        }
+    }
+}
+
+Level::~Level() {
+    if(music != NULL) {
+        Mix_FreeMusic(music);
+    }
+}
+
+static bool layerOrder(const TileLayer &a, const TileLayer &b) {
+    return a.order < b.order;
+}
+
+TileLayer::TileLayer() : tiles(mapHeight * mapWidth, 0), parallax(1.0f), collision(true), foreground(false), order(0), indexTexture(0), mapAlpha(ALPHA_TRANSLUCENT), mapClassified(false) {
+    for(int i = 0; i < TILE_BANDS; i++) {
+        bandUploadPending[i] = false;
+        bandStale[i] = false;
+    }
+}
+
+bool Level::Load(const std::string &levelFile, const std::string &musicFile, bool looseOnly) {
+    file = levelFile;
+    std::ifstream looseFile;
+    MemoryBuffer packedFile;
+    std::istream gamedata(NULL);
+    AssetSpan span;
+    if(!looseOnly && FindAsset(levelFile, span)) {
+        packedFile.Set(span);
+        gamedata.rdbuf(&packedFile);
+    } else {
+        looseFile.open(levelFile);
+        if(looseFile.fail()) {
+            std::cout << "Error opening level file:" << levelFile << std::endl;
+            return false;
+        }
+        gamedata.rdbuf(looseFile.rdbuf());
+    }
+    std::string line;
+    while (getline(gamedata, line)) {
+        if (line == "[layer]") {
+            readLayerData(gamedata);
+        }
+        else if (line == "[ObjectsLayer]") {
+            readEntityData(gamedata);
+        }
+    }
+    std::stable_sort(layers.begin(), layers.end(), layerOrder);
+    buildCollision();
+    for(size_t i = 0; i < layers.size(); i++) {
+        layers[i].BuildMesh();
+    }
+
+    //Mix_LoadMUS opens the file and sets up the decoder, so do it here instead of at the swap
+    if(musicFile != "") {
+        music = Mix_LoadMUS_RW(OpenAssetRW(musicFile), 1);
+    }
+    return true;
+}
+
+bool Level::readLayerData(std::istream &stream) {
+    TileLayer layer;
+    layer.order = (int)layers.size();
+    std::string line;
+    while(getline(stream, line)) {
+        if(line == "") {
+            break;
+        }
+        std::istringstream sStream(line);
+        std::string key,value;
+        getline(sStream, key, '=');
+        getline(sStream, value);
+
+        if(key == "type") {
+            layer.name = value;
+        }
+        else if(key == "parallax") {
+            layer.parallax = (float)atof(value.c_str());
+        }
+        else if(key == "collision") {
+            layer.collision = (value == "true" || value == "1");
+        }
+        else if(key == "foreground") {
+            layer.foreground = (value == "true" || value == "1");
+        }
+        else if(key == "order") {
+            layer.order = atoi(value.c_str());
+        }
+        else if(key == "data") {
+            for(int y = 0; y < mapHeight; y++) {
+                getline(stream, line);
+                std::istringstream lineStream(line);
+                std::string tile;
+                for(int x = 0; x < mapWidth; x++) {
+                    getline(lineStream, tile, ',');
+                    int val =  atoi(tile.c_str());
+                    if(val > 0) {
+                        // be careful, the tiles in this format are indexed from 1 not 0
+                        layer.tiles[y * mapWidth + x] = val-1;
+                    } else {
+                        layer.tiles[y * mapWidth + x] = 0;
+                    }
+                }
+            } }
+    }
+    layers.push_back(layer);
+    return true;
+}
+
+//later collision layers win where they overlap, layers without collision are never looked at again
+void Level::buildCollision() {
+    for(int y = 0; y < mapHeight; y++) {
+        for(int x = 0; x < mapWidth; x++) {
+            levelData[y][x] = 0;
+            for(size_t i = 0; i < layers.size(); i++) {
+                if(layers[i].collision && layers[i].tiles[y * mapWidth + x] != 0) {
+                    levelData[y][x] = layers[i].tiles[y * mapWidth + x];
+                }
+            }
+        }
+    }
+}
+
+bool Level::readEntityData(std::istream &stream) {
+    std::string line;
+    std::string type;
+    while(getline(stream, line)) {
+        if(line == "") {
+            break;
+        }
+
+        std::istringstream sStream(line);
+        std::string key,value;
+        getline(sStream, key, '=');
+        getline(sStream, value);
+        if(key == "type") {
+            type = value;
+        }
+        else if(key == "location") {
+            std::istringstream lineStream(value);
+            std::string xPosition, yPosition;
+            getline(lineStream, xPosition, ',');
+            getline(lineStream, yPosition, ',');
+            float placeX = atoi(xPosition.c_str())*TILE_SIZE;
+            float placeY = atoi(yPosition.c_str())*-TILE_SIZE;
+            entities.push_back(LevelEntity(type, placeX, placeY));
+        }
+    }
+    return true;
+}
+
+//the meshes are built once at load and then live on the GPU, an edited tile only rebuilds its band
+//each band of rows is meshed as a separate job
+void TileLayer::BuildMesh() {
+    Jobs().ParallelFor(0, TILE_BANDS, 1, [this](int first, int last) {
+        for(int band = first; band < last; band++) {
+            buildBand(band);
+        }
+    });
+}
+
+void TileLayer::buildBand(int band) {
+    int lastRow = (band + 1) * TILE_CHUNK_ROWS < mapHeight ? (band + 1) * TILE_CHUNK_ROWS : mapHeight;
+    bandData[band].clear();
+    BuildRows(band * TILE_CHUNK_ROWS, lastRow, bandData[band]);
+    bandUploadPending[band] = true;
+    bandStale[band] = false;
+}
+
+void TileLayer::BuildRows(int firstRow, int lastRow, std::vector<TileVertex> &out) const {
+    for(int y=firstRow; y < lastRow; y++) {
+        for(int x=0; x < mapWidth; x++) {
+            int tile = tiles[y * mapWidth + x];
+            if(tile != 0) {
+                float u = (float)(tile % SPRITE_COUNT_X) / (float) SPRITE_COUNT_X;
+                float v = (float)(tile / SPRITE_COUNT_X) / (float) SPRITE_COUNT_Y;
+                float spriteWidth = 1.0f/(float)SPRITE_COUNT_X;
+                float spriteHeight = 1.0f/(float)SPRITE_COUNT_Y;
+                GLushort left = PackTexCoord(u);
+                GLushort right = PackTexCoord(u+spriteWidth);
+                GLushort top = PackTexCoord(v);
+                GLushort bottom = PackTexCoord(v+spriteHeight);
+                //in whole tiles, Level::Draw scales by TILE_SIZE
+                TileVertex corners[4] = {
+                    {(GLshort)x, (GLshort)-y, left, top},
+                    {(GLshort)x, (GLshort)(-y-1), left, bottom},
+                    {(GLshort)(x+1), (GLshort)(-y-1), right, bottom},
+                    {(GLshort)(x+1), (GLshort)-y, right, top}
+                };
+                out.insert(out.end(), corners, corners + 4);
+            }
+        }
+    }
+}
+
+void TileLayer::uploadBand(int band, GLuint tileTexture) {
+    const std::vector<TileVertex> &vertexData = bandData[band];
+    std::vector<TileVertex> classified[ALPHA_CLASS_COUNT];
+    for(size_t i = 0; i + 3 < vertexData.size(); i += 4) {
+        //corners 0 and 2 are the top left and bottom right
+        AlphaClass alpha = TextureRegionAlpha(tileTexture, UnpackTexCoord(vertexData[i].u), UnpackTexCoord(vertexData[i].v),
+                                              UnpackTexCoord(vertexData[i + 2].u), UnpackTexCoord(vertexData[i + 2].v));
+        classified[alpha].insert(classified[alpha].end(), vertexData.begin() + i, vertexData.begin() + i + 4);
+    }
+    for(int i = 0; i < ALPHA_CLASS_COUNT; i++) {
+        //an edit can empty a class the band had before, its buffer is kept and drawn as nothing
+        if(!classified[i].empty() || meshes[band][i].vertexBuffer != 0) {
+            meshes[band][i].Upload(classified[i].data(), (int)classified[i].size() / 4, VERTEX_TILE, GL_STATIC_DRAW);
+        }
+    }
+
+    //the GPU copy is all that is needed from here on
+    std::vector<TileVertex>().swap(bandData[band]);
+    bandUploadPending[band] = false;
+}
+
+void TileLayer::Release() {
+    for(int band = 0; band < TILE_BANDS; band++) {
+        for(int i = 0; i < ALPHA_CLASS_COUNT; i++) {
+            meshes[band][i].Release();
+        }
+    }
+    if(indexTexture != 0) {
+        DeleteTexture(indexTexture);
+        indexTexture = 0;
+    }
+}
+
+void TileLayer::UploadIndexTexture() {
+    std::vector<GLushort> ids(tiles.begin(), tiles.end());
+    glGenTextures(1, &indexTexture);
+    BindTexture(indexTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+    if(CurrentRenderBackend() == RENDER_CORE) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R16UI, mapWidth, mapHeight, 0, GL_RED_INTEGER, GL_UNSIGNED_SHORT, ids.data());
+    } else {
+        //little endian, so the low byte lands in luminance and the high byte in alpha
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE_ALPHA, mapWidth, mapHeight, 0, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, ids.data());
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    //ids can't be blended, every lookup has to land on exactly one tile
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void TileLayer::SetTile(int x, int y, int tile) {
+    tiles[y * mapWidth + x] = tile;
+    mapClassified = false;
+    //an index texture means the layer is drawn through the tilemap shader and has no meshes to rebuild
+    if(indexTexture == 0) {
+        bandStale[y / TILE_CHUNK_ROWS] = true;
+    } else {
+        GLushort id = (GLushort)tile;
+        BindTexture(indexTexture);
+        if(CurrentRenderBackend() == RENDER_CORE) {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_SHORT, &id);
+        } else {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, 1, 1, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, &id);
+        }
+    }
+}
+
+void TileLayer::Prepare(GLuint tileTexture) {
+    for(int band = 0; band < TILE_BANDS; band++) {
+        if(bandStale[band]) {
+            buildBand(band);
+        }
+        if(bandUploadPending[band]) {
+            uploadBand(band, tileTexture);
+        }
+    }
+}
+
+bool TileLayer::BandPending(int band) const {
+    return bandUploadPending[band] || bandStale[band];
+}
+
+void TileLayer::ClassifyMap(GLuint tileTexture) {
+    //empty cells are discarded by the shader, so the quad is never better than alpha tested
+    mapAlpha = ALPHA_TESTED;
+    for(size_t i = 0; i < tiles.size() && mapAlpha != ALPHA_TRANSLUCENT; i++) {
+        if(tiles[i] != 0) {
+            float u = (float)(tiles[i] % SPRITE_COUNT_X) / (float) SPRITE_COUNT_X;
+            float v = (float)(tiles[i] / SPRITE_COUNT_X) / (float) SPRITE_COUNT_Y;
+            mapAlpha = WorstAlphaClass(mapAlpha, TextureRegionAlpha(tileTexture, u, v, u + 1.0f/(float)SPRITE_COUNT_X, v + 1.0f/(float)SPRITE_COUNT_Y));
+        }
+    }
+    mapClassified = true;
+}
+
+//used by hot reload, the entities and music of this level are left alone
+void Level::TakeTiles(Level &other) {
+    ReleaseMeshes();
+    for(int y = 0; y < mapHeight; y++) {
+        for(int x = 0; x < mapWidth; x++) {
+            levelData[y][x] = other.levelData[y][x];
+        }
+    }
+    layers.swap(other.layers);
+}
+
+bool Level::TakeChangedTiles(const Level &other) {
+    if(other.layers.size() != layers.size()) {
+        return false;
+    }
+    for(size_t i = 0; i < layers.size(); i++) {
+        const TileLayer &a = layers[i];
+        const TileLayer &b = other.layers[i];
+        if(a.name != b.name || a.parallax != b.parallax || a.collision != b.collision || a.foreground != b.foreground || a.order != b.order) {
+            return false;
+        }
+    }
+    for(size_t i = 0; i < layers.size(); i++) {
+        for(int y = 0; y < mapHeight; y++) {
+            for(int x = 0; x < mapWidth; x++) {
+                int tile = other.layers[i].tiles[y * mapWidth + x];
+                if(layers[i].tiles[y * mapWidth + x] != tile) {
+                    SetTile((int)i, x, y, tile);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void Level::ReleaseMeshes() {
+    for(size_t i = 0; i < layers.size(); i++) {
+        layers[i].Release();
+    }
+    mapQuad.Release();
+}
+
+void Level::SetTile(int layer, int x, int y, int tile) {
+    layers[layer].SetTile(x, y, tile);
+    if(layers[layer].collision) {
+        levelData[y][x] = 0;
+        for(size_t i = 0; i < layers.size(); i++) {
+            if(layers[i].collision && layers[i].tiles[y * mapWidth + x] != 0) {
+                levelData[y][x] = layers[i].tiles[y * mapWidth + x];
+            }
+        }
+    }
+}
+
+//a layer with parallax p follows the camera by (1 - p) so it appears to scroll at p times the speed
+Matrix Level::layerMatrix(const TileLayer &layer, const Matrix &view) const {
+    float cameraX = -view.m[3][0];
+    float cameraY = -view.m[3][1];
+    Matrix layerMatrix;
+    layerMatrix.Translate(cameraX * (1.0f - layer.parallax), cameraY * (1.0f - layer.parallax), 0.0f);
+    layerMatrix.Scale(TILE_SIZE, TILE_SIZE, 1.0f);
+    return view * layerMatrix;
+}
+
+void Level::PrepareDraw(ShaderProgram *tileMapProgram, GLuint tileTexture) {
+    if(tileMapProgram == NULL) {
+        for(size_t i = 0; i < layers.size(); i++) {
+            layers[i].Prepare(tileTexture);
+        }
+        return;
+    }
+
+    if(mapQuad.vertexBuffer == 0) {
+        //texCoords run over the whole map, the shader scales them back up to tiles
+        SpriteVertex corners[4];
+        SetQuad(corners, 0.0f, 0.0f, (float)mapWidth, -(float)mapHeight, 0.0f, 0.0f, 1.0f, 1.0f);
+        mapQuad.Upload(corners, 1, VERTEX_SPRITE, GL_STATIC_DRAW);
+    }
+    for(size_t i = 0; i < layers.size(); i++) {
+        if(layers[i].indexTexture == 0) {
+            layers[i].UploadIndexTexture();
+        }
+        if(!layers[i].mapClassified) {
+            layers[i].ClassifyMap(tileTexture);
+        }
+    }
+    tileMapProgram->SetUniform("diffuse", 0);
+    tileMapProgram->SetUniform("tileIndex", 1);
+    tileMapProgram->SetUniform("mapSize", (float)mapWidth, (float)mapHeight);
+    tileMapProgram->SetUniform("sheetSize", (float)SPRITE_COUNT_X, (float)SPRITE_COUNT_Y);
+}
+
+//layers keep their file order through the depth part of the key
+//the meshes may not be uploaded yet, PrepareDraw() runs before the queue is flushed
+void Level::Submit(RenderQueue &queue, ShaderProgram *program, GLuint tileTexture, const Matrix &view, bool foreground) {
+    for(size_t i = 0; i < layers.size(); i++) {
+        if(layers[i].foreground != foreground) {
+            continue;
+        }
+        Matrix modelview = layerMatrix(layers[i], view);
+        for(int band = 0; band < TILE_BANDS; band++) {
+            bool pending = layers[i].BandPending(band);
+            for(int alpha = 0; alpha < ALPHA_CLASS_COUNT; alpha++) {
+                Mesh *mesh = &layers[i].meshes[band][alpha];
+                if(!pending && mesh->quadCount == 0) {
+                    continue;
+                }
+                queue.SubmitMesh(foreground ? LAYER_TILES_FRONT : LAYER_TILES_BACK, program, tileTexture, 0, modelview, mesh, (AlphaClass)alpha, (int)i);
+            }
+        }
+    }
+}
+
+void Level::SubmitTileMap(RenderQueue &queue, ShaderProgram *tileMapProgram, GLuint tileTexture, const Matrix &view, bool foreground) {
+    for(size_t i = 0; i < layers.size(); i++) {
+        if(layers[i].foreground != foreground) {
+            continue;
+        }
+        queue.SubmitMesh(foreground ? LAYER_TILES_FRONT : LAYER_TILES_BACK, tileMapProgram, tileTexture, layers[i].indexTexture, layerMatrix(layers[i], view), &mapQuad, layers[i].mapAlpha, (int)i);
+    }
+}
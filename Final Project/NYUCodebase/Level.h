@@ -0,0 +1,131 @@
+#pragma once
+
+#include "GLPlatform.h"
+#include <SDL_mixer.h>
+#include <string>
+#include <vector>
+#include <istream>
+#include "ShaderProgram.h"
+#include "Matrix.h"
+#include "Mesh.h"
+#include "RenderQueue.h"
+#include "TextureAlpha.h"
+
+#define TILE_SIZE 1.0f
+#define SPRITE_COUNT_X 16
+#define SPRITE_COUNT_Y 8
+#define mapHeight 25
+#define mapWidth 90
+//rows of tiles meshed by one job, each band gets its own meshes so an edit only rebuilds its band
+#define TILE_CHUNK_ROWS 5
+#define TILE_BANDS ((mapHeight + TILE_CHUNK_ROWS - 1) / TILE_CHUNK_ROWS)
+
+class LevelEntity {
+    public:
+        LevelEntity(const std::string &entityType, float xPosition, float yPosition) :
+        type(entityType), x(xPosition), y(yPosition) {}
+
+        std::string type;
+        float x;
+        float y;
+};
+
+//one [layer] section of a level file with its own meshes, uploaded once and drawn from the GPU copy
+//optional keys in the section: parallax=0.5 collision=false foreground=true order=2
+class TileLayer {
+    public:
+        TileLayer();
+
+        void BuildMesh();
+        void Release();
+        //rebuilds the bands edited since the last draw and uploads the ones that aren't on the GPU yet
+        void Prepare(GLuint tileTexture);
+        //false when the band's meshes are final and meshes[band][alpha] can be skipped if empty
+        bool BandPending(int band) const;
+        //the worst class of any tile in the layer, for when it is drawn as one quad
+        void ClassifyMap(GLuint tileTexture);
+
+        //the tile ids as a mapWidth x mapHeight texture for the tilemap shader, 2 bytes a tile
+        //16 bit unsigned integers on core contexts, split over luminance and alpha on older ones
+        void UploadIndexTexture();
+        //a 2 byte texture update on the tilemap path, the mesh path rebuilds the band holding y on its next Prepare()
+        void SetTile(int x, int y, int tile);
+
+        //the quads of rows [firstRow, lastRow) appended to out, one BuildMesh() job
+        void BuildRows(int firstRow, int lastRow, std::vector<TileVertex> &out) const;
+
+        std::string name;
+        std::vector<int> tiles;
+
+        float parallax;
+        bool collision;
+        bool foreground;
+        int order;
+
+        //four corners per tile in tile units, per band, until uploadBand() hands them to the meshes
+        std::vector<TileVertex> bandData[TILE_BANDS];
+        //one per AlphaClass, so opaque tiles never pay for blending
+        Mesh meshes[TILE_BANDS][ALPHA_CLASS_COUNT];
+
+        GLuint indexTexture;
+        AlphaClass mapAlpha;
+        bool mapClassified;
+
+    private:
+        void buildBand(int band);
+        //splits the band's tiles by how their part of the sheet has to be blended
+        void uploadBand(int band, GLuint tileTexture);
+
+        //built but not uploaded yet
+        bool bandUploadPending[TILE_BANDS];
+        //tiles changed since the band was built
+        bool bandStale[TILE_BANDS];
+};
+
+//everything a level needs to be played: tiles, entity spawns, the tile mesh and its music
+//Load() touches no GL or game state so it can run on a worker thread
+class Level {
+    public:
+        Level();
+        ~Level();
+
+        //looseOnly skips the asset pack, for reloading a file that was edited after the pack was built
+        bool Load(const std::string &levelFile, const std::string &musicFile, bool looseOnly = false);
+        void TakeTiles(Level &other);
+        //hot reload with the same layers, only the tiles that differ are set, false if the layers changed
+        bool TakeChangedTiles(const Level &other);
+
+        //uploads whatever the next submits will draw from, needs the GL context
+        //pass the tilemap program when the layers will be drawn through it
+        void PrepareDraw(ShaderProgram *tileMapProgram, GLuint tileTexture);
+
+        //queues the layers behind or in front of the entities
+        void Submit(RenderQueue &queue, ShaderProgram *program, GLuint tileTexture, const Matrix &view, bool foreground);
+        //same, but every layer is one quad and the tilemap shader looks the tiles up in its index texture
+        //so the cost only depends on how much of the screen the map covers
+        void SubmitTileMap(RenderQueue &queue, ShaderProgram *tileMapProgram, GLuint tileTexture, const Matrix &view, bool foreground);
+
+        //changes one tile, its index texture gets a 2 byte update and its mesh is rebuilt on the next draw
+        void SetTile(int layer, int x, int y, int tile);
+        //frees the GPU meshes, has to happen on the GL thread before the level is handed off
+        void ReleaseMeshes();
+
+        std::string file;
+
+        //merged from the collision layers, this is what entities collide against
+        int levelData[mapHeight][mapWidth];
+        std::vector<TileLayer> layers;
+        std::vector<LevelEntity> entities;
+
+        //freed with the level, LevelManager hands it to the audio thread instead once there is one
+        Mix_Music *music;
+
+        //the whole map as one quad, only used by SubmitTileMap
+        Mesh mapQuad;
+
+    private:
+        Matrix layerMatrix(const TileLayer &layer, const Matrix &view) const;
+        bool readLayerData(std::istream &stream);
+        void buildCollision();
+        bool readEntityData(std::istream &stream);
+};
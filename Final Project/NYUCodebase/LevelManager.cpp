@@ -0,0 +1,176 @@
+#include "LevelManager.h"
+#include <chrono>
+
+//how long the loader sleeps when nothing is asked of it, and how often a wait checks on it
+#define LOADER_POLL_MS 1
+
+LevelManager::LevelManager() : current(NULL), currentIndex(-1), next(NULL), nextIndex(-1), loadsPending(0), loaderRunning(false), audio(NULL), transitionRequested(false) {}
+
+LevelManager::~LevelManager() {
+    WaitForPreload();
+    loaderRunning = false;
+    if(loader.joinable()) {
+        loader.join();
+    }
+    destroy(current);
+    destroy(next);
+    for(size_t i = 0; i < unreleased.size(); i++) {
+        destroy(unreleased[i]);
+    }
+    for(size_t i = 0; i < retired.size(); i++) {
+        destroy(retired[i]);
+    }
+}
+
+void LevelManager::SetAudio(AudioThread *audioThread) {
+    audio = audioThread;
+}
+
+void LevelManager::destroy(Level *level) {
+    if(level == NULL) {
+        return;
+    }
+    if(audio != NULL) {
+        audio->FreeMusic(level->music);
+        level->music = NULL;
+    }
+    delete level;
+}
+
+void LevelManager::AddLevel(const std::string &levelFile, const std::string &musicFile) {
+    levelFiles.push_back(levelFile);
+    musicFiles.push_back(musicFile);
+}
+
+int LevelManager::LevelCount() const {
+    return (int)levelFiles.size();
+}
+
+const std::string& LevelManager::LevelFile(int index) const {
+    return levelFiles[index];
+}
+
+void LevelManager::WaitForPreload() {
+    while(loadsPending > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(LOADER_POLL_MS));
+    }
+}
+
+void LevelManager::runLoader() {
+    while(loaderRunning) {
+        LoadRequest request;
+        if(!requests.TryPop(request)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(LOADER_POLL_MS));
+            continue;
+        }
+        //freeing the old levels' music and tiles is also kept off the simulation thread
+        for(size_t i = 0; i < request.retired.size(); i++) {
+            destroy(request.retired[i]);
+        }
+        request.level->Load(request.levelFile, request.musicFile);
+        loadsPending--;
+    }
+}
+
+void LevelManager::Preload(int index) {
+    //the current level is already loaded, replacing the preloaded one with a copy of it would only cost the next transition
+    if(index < 0 || index >= LevelCount() || index == nextIndex || (current != NULL && index == currentIndex)) {
+        return;
+    }
+    WaitForPreload();
+    destroy(next);
+
+    next = new Level();
+    nextIndex = index;
+    LoadRequest request;
+    request.level = next;
+    request.levelFile = levelFiles[index];
+    request.musicFile = musicFiles[index];
+    {
+        std::lock_guard<std::mutex> guard(retiredLock);
+        request.retired.swap(retired);
+    }
+
+    if(!loaderRunning) {
+        loaderRunning = true;
+        loader = std::thread(&LevelManager::runLoader, this);
+    }
+    //one load at a time, the wait above leaves the ring empty
+    loadsPending++;
+    requests.TryPush(request);
+}
+
+Level* LevelManager::Start(int index) {
+    transitionRequested = false;
+    if(current != NULL && currentIndex == index) {
+        //restarting, the level after it may have been replaced since the first start
+        Preload(index + 1);
+        return current;
+    }
+
+    Preload(index);
+    WaitForPreload();
+
+    //this can run from Update, so the old level's meshes wait for ReleaseRetired() on the GL thread
+    if(current != NULL) {
+        std::lock_guard<std::mutex> guard(retiredLock);
+        unreleased.push_back(current);
+    }
+    current = next;
+    currentIndex = index;
+    next = NULL;
+    nextIndex = -1;
+
+    Preload(index + 1);
+    return current;
+}
+
+void LevelManager::ReleaseRetired(const Level *drawing) {
+    std::lock_guard<std::mutex> guard(retiredLock);
+    //once its meshes are gone the next preload frees it, by then its music has been replaced
+    std::vector<Level*> stillDrawn;
+    for(size_t i = 0; i < unreleased.size(); i++) {
+        if(unreleased[i] == drawing) {
+            stillDrawn.push_back(unreleased[i]);
+            continue;
+        }
+        unreleased[i]->ReleaseMeshes();
+        retired.push_back(unreleased[i]);
+    }
+    unreleased.swap(stillDrawn);
+}
+
+void LevelManager::RequestNext() {
+    transitionRequested = true;
+}
+
+bool LevelManager::TransitionPending() const {
+    return transitionRequested;
+}
+
+bool LevelManager::HasNext() const {
+    return currentIndex + 1 < LevelCount();
+}
+
+Level* LevelManager::Advance() {
+    transitionRequested = false;
+    if(!HasNext()) {
+        return NULL;
+    }
+    return Start(currentIndex + 1);
+}
+
+void LevelManager::ReloadTiles(Level *level) {
+    if(current != NULL && current->file == level->file) {
+        if(!current->TakeChangedTiles(*level)) {
+            current->TakeTiles(*level);
+        }
+    }
+    else if(nextIndex != -1 && levelFiles[nextIndex] == level->file) {
+        WaitForPreload();
+        if(!next->TakeChangedTiles(*level)) {
+            next->TakeTiles(*level);
+        }
+    }
+    destroy(level);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include "Level.h"
+#include "MessageQueue.h"
+#include "AudioThread.h"
+
+//keeps the next level parsed, meshed and its music opened on a loader thread
+//so moving to it is just a pointer swap
+//Preload() and Start() come from one thread at a time, first the main thread and then the simulation
+class LevelManager {
+    public:
+        LevelManager();
+        ~LevelManager();
+
+        void AddLevel(const std::string &levelFile, const std::string &musicFile);
+        //levels deleted after this send their music to the audio thread to be freed, it may be playing it
+        void SetAudio(AudioThread *audioThread);
+        int LevelCount() const;
+        const std::string& LevelFile(int index) const;
+
+        //starts loading a level in the background, does nothing if it is already current, loaded or loading
+        void Preload(int index);
+
+        //makes the level current and begins preloading the one after it, the caller starts its music
+        //only blocks if the level was never preloaded
+        Level* Start(int index);
+
+        //blocks until the level being preloaded, if any, is ready
+        void WaitForPreload();
+
+        //frees the meshes of levels that Start() swapped out, call it from the GL thread every frame
+        //Start() runs on the simulation thread, so the level the render thread is still drawing is kept until it moves on
+        void ReleaseRetired(const Level *drawing = NULL);
+
+        //collision handlers only flag the transition, Advance() does the swap at the end of the tick
+        void RequestNext();
+        bool TransitionPending() const;
+        bool HasNext() const;
+        Level* Advance();
+
+        //replaces the tiles of the current or preloaded level that was loaded from the same file
+        //when the layers are the same only the edited tiles are set, otherwise every layer is swapped
+        //needs the GL thread, the tilemap path updates the index textures right away
+        void ReloadTiles(Level *level);
+
+        Level *current;
+        int currentIndex;
+
+    private:
+        class LoadRequest {
+            public:
+                Level *level;
+                //freed on the loader thread before the level loads
+                std::vector<Level*> retired;
+                std::string levelFile;
+                std::string musicFile;
+        };
+
+        void runLoader();
+        //from any thread that deletes a level
+        void destroy(Level *level);
+
+        std::vector<std::string> levelFiles;
+        std::vector<std::string> musicFiles;
+
+        Level *next;
+        int nextIndex;
+        //swapped out but still holding GPU meshes, then waiting for a preload to free them
+        //the GL thread and the simulation thread both get at these
+        std::mutex retiredLock;
+        std::vector<Level*> unreleased;
+        std::vector<Level*> retired;
+
+        SPSCQueue<LoadRequest, 4> requests;
+        //requests not finished yet, the load is visible to whoever sees this drop
+        std::atomic<int> loadsPending;
+        std::thread loader;
+        std::atomic<bool> loaderRunning;
+        AudioThread *audio;
+        bool transitionRequested;
+};
@@ -0,0 +1,126 @@
+#include "LowResTarget.h"
+#include "GLState.h"
+#include "RenderBackend.h"
+#include <SDL.h>
+#include <iostream>
+
+LowResTarget::LowResTarget() : width(0), height(0), textureWidth(0), textureHeight(0), framebuffer(0), colorTexture(0), depthBuffer(0), filter(UPSCALE_INTEGER), program(NULL) {}
+
+bool LowResTarget::Init(int targetWidth, int targetHeight, UpscaleFilter upscaleFilter, ShaderProgram *upscaleProgram) {
+    if(CurrentRenderBackend() != RENDER_CORE && !SDL_GL_ExtensionSupported("GL_ARB_framebuffer_object")) {
+        std::cout << "No framebuffer objects, drawing straight to the window" << std::endl;
+        return false;
+    }
+    width = textureWidth = targetWidth;
+    height = textureHeight = targetHeight;
+    filter = upscaleFilter;
+    program = upscaleProgram;
+
+    glGenTextures(1, &colorTexture);
+    BindTexture(colorTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, textureWidth, textureHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    //sharp bilinear relies on the hardware blend between neighbouring texels
+    GLint sampling = filter == UPSCALE_SHARP_BILINEAR ? GL_LINEAR : GL_NEAREST;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, sampling);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, sampling);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    //the render queue depth tests opaque sprites, so the target needs its own depth
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, textureWidth, textureHeight);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if(status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "Low resolution framebuffer is incomplete (" << status << "), drawing straight to the window" << std::endl;
+        Release();
+        return false;
+    }
+
+    //the texture's first row is the bottom of the picture
+    SpriteVertex corners[4];
+    SetQuad(corners, -1.0f, 1.0f, 1.0f, -1.0f, 0.0f, 1.0f, 1.0f, 0.0f);
+    screenQuad.Upload(corners, 1, VERTEX_SPRITE, GL_STATIC_DRAW);
+    return true;
+}
+
+void LowResTarget::Release() {
+    if(framebuffer != 0) {
+        glDeleteFramebuffers(1, &framebuffer);
+        framebuffer = 0;
+    }
+    if(depthBuffer != 0) {
+        glDeleteRenderbuffers(1, &depthBuffer);
+        depthBuffer = 0;
+    }
+    if(colorTexture != 0) {
+        DeleteTexture(colorTexture);
+        colorTexture = 0;
+    }
+    screenQuad.Release();
+}
+
+bool LowResTarget::Active() const {
+    return framebuffer != 0;
+}
+
+void LowResTarget::SetSize(int targetWidth, int targetHeight) {
+    width = targetWidth < textureWidth ? targetWidth : textureWidth;
+    height = targetHeight < textureHeight ? targetHeight : textureHeight;
+}
+
+void LowResTarget::Begin() {
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+}
+
+void LowResTarget::Present(int windowWidth, int windowHeight) {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, windowWidth, windowHeight);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    if(filter == UPSCALE_INTEGER) {
+        int scale = windowWidth / width < windowHeight / height ? windowWidth / width : windowHeight / height;
+        int scaledWidth = width * scale;
+        int scaledHeight = height * scale;
+        GLenum sampling = GL_NEAREST;
+        //a window smaller than the target can't be pixel perfect, shrink it to fit instead
+        if(scale < 1) {
+            float fit = (float)windowWidth / width < (float)windowHeight / height ? (float)windowWidth / width : (float)windowHeight / height;
+            scaledWidth = (int)(width * fit);
+            scaledHeight = (int)(height * fit);
+            sampling = GL_LINEAR;
+        }
+        int x = (windowWidth - scaledWidth) / 2;
+        int y = (windowHeight - scaledHeight) / 2;
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glBlitFramebuffer(0, 0, width, height, x, y, x + scaledWidth, y + scaledHeight, GL_COLOR_BUFFER_BIT, sampling);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        return;
+    }
+
+    float fit = (float)windowWidth / width < (float)windowHeight / height ? (float)windowWidth / width : (float)windowHeight / height;
+    int scaledWidth = (int)(width * fit);
+    int scaledHeight = (int)(height * fit);
+    glViewport((windowWidth - scaledWidth) / 2, (windowHeight - scaledHeight) / 2, scaledWidth, scaledHeight);
+
+    SetBlend(false);
+    SetDepthTest(false);
+    Matrix identity;
+    program->SetProjectionMatrix(identity);
+    program->SetModelviewMatrix(identity);
+    program->SetUniform("diffuse", 0);
+    program->SetUniform("sourceSize", (float)width, (float)height);
+    program->SetUniform("textureSize", (float)textureWidth, (float)textureHeight);
+    program->SetUniform("scale", (float)scaledWidth / width, (float)scaledHeight / height);
+    ActiveTexture(0);
+    BindTexture(colorTexture);
+    screenQuad.Draw();
+}
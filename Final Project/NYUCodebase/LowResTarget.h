@@ -0,0 +1,46 @@
+#pragma once
+
+#include "GLPlatform.h"
+#include "Mesh.h"
+#include "ShaderProgram.h"
+
+//integer scales one blit with nearest filtering, sharp bilinear fills as much of the window as the aspect allows
+//and only blends across the one window pixel wide seam between source pixels
+enum UpscaleFilter { UPSCALE_INTEGER, UPSCALE_SHARP_BILINEAR };
+
+//the scene is drawn at pixel art resolution into a framebuffer object and scaled up to the window in one pass,
+//so fill cost stays the same whatever size the window is
+class LowResTarget {
+    public:
+        LowResTarget();
+
+        //needs the GL context, false if there are no framebuffer objects and the scene has to go straight to the window
+        //the program is only used for sharp bilinear
+        //the size given here is the largest it can be drawn at
+        bool Init(int targetWidth, int targetHeight, UpscaleFilter upscaleFilter, ShaderProgram *upscaleProgram);
+        void Release();
+        bool Active() const;
+
+        //smaller sizes draw into the bottom left corner of the same texture, so changing it costs nothing
+        void SetSize(int targetWidth, int targetHeight);
+
+        //everything drawn after this lands in the target
+        void Begin();
+        //scales the target into the middle of the window, what is left over is black
+        void Present(int windowWidth, int windowHeight);
+
+        int width;
+        int height;
+
+    private:
+        int textureWidth;
+        int textureHeight;
+
+        GLuint framebuffer;
+        GLuint colorTexture;
+        GLuint depthBuffer;
+
+        UpscaleFilter filter;
+        ShaderProgram *program;
+        Mesh screenQuad;
+};
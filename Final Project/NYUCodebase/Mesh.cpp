@@ -0,0 +1,135 @@
+#include "Mesh.h"
+#include "GLState.h"
+#include "RenderBackend.h"
+#include "ShaderProgram.h"
+#include "RenderStats.h"
+#include <iostream>
+
+static GLuint quadIndexBuffer = 0;
+
+void SetQuad(SpriteVertex *corners, float left, float top, float right, float bottom, float u0, float v0, float u1, float v1) {
+    float xs[4] = {left, left, right, right};
+    float ys[4] = {top, bottom, bottom, top};
+    float us[4] = {u0, u0, u1, u1};
+    float vs[4] = {v0, v1, v1, v0};
+    for(int i = 0; i < 4; i++) {
+        corners[i].x = xs[i];
+        corners[i].y = ys[i];
+        corners[i].u = PackTexCoord(us[i]);
+        corners[i].v = PackTexCoord(vs[i]);
+        corners[i].color[0] = 255;
+        corners[i].color[1] = 255;
+        corners[i].color[2] = 255;
+        corners[i].color[3] = 255;
+    }
+}
+
+void BindVertexLayout(GLuint vertexBuffer, VertexFormat format, size_t offset) {
+    BindArrayBuffer(vertexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, QuadIndexBuffer());
+    if(format == VERTEX_TILE) {
+        glVertexAttribPointer(POSITION_ATTRIBUTE, 2, GL_SHORT, false, sizeof(TileVertex), (void*)offset);
+        glVertexAttribPointer(TEXCOORD_ATTRIBUTE, 2, GL_UNSIGNED_SHORT, true, sizeof(TileVertex), (void*)(offset + 2 * sizeof(GLshort)));
+        SetAttributeEnabled(COLOR_ATTRIBUTE, false);
+    } else {
+        glVertexAttribPointer(POSITION_ATTRIBUTE, 2, GL_FLOAT, false, sizeof(SpriteVertex), (void*)offset);
+        glVertexAttribPointer(TEXCOORD_ATTRIBUTE, 2, GL_UNSIGNED_SHORT, true, sizeof(SpriteVertex), (void*)(offset + 2 * sizeof(float)));
+        glVertexAttribPointer(COLOR_ATTRIBUTE, 4, GL_UNSIGNED_BYTE, true, sizeof(SpriteVertex), (void*)(offset + 2 * sizeof(float) + 2 * sizeof(GLushort)));
+        SetAttributeEnabled(COLOR_ATTRIBUTE, true);
+    }
+    SetAttributeEnabled(POSITION_ATTRIBUTE, true);
+    SetAttributeEnabled(TEXCOORD_ATTRIBUTE, true);
+}
+
+GLuint QuadIndexBuffer() {
+    if(quadIndexBuffer == 0) {
+        std::vector<GLushort> indices(MAX_QUADS * 6);
+        for(int i = 0; i < MAX_QUADS; i++) {
+            GLushort corner = (GLushort)(i * 4);
+            indices[i * 6 + 0] = corner;
+            indices[i * 6 + 1] = corner + 1;
+            indices[i * 6 + 2] = corner + 2;
+            indices[i * 6 + 3] = corner;
+            indices[i * 6 + 4] = corner + 2;
+            indices[i * 6 + 5] = corner + 3;
+        }
+        glGenBuffers(1, &quadIndexBuffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadIndexBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), indices.data(), GL_STATIC_DRAW);
+    }
+    return quadIndexBuffer;
+}
+
+void ReleaseQuadIndexBuffer() {
+    if(quadIndexBuffer != 0) {
+        DeleteBuffer(quadIndexBuffer);
+        quadIndexBuffer = 0;
+    }
+}
+
+Mesh::Mesh() : vertexArray(0), vertexBuffer(0), format(VERTEX_SPRITE), quadCount(0), capacity(0) {}
+
+void Mesh::Upload(const void *vertices, int quads, VertexFormat vertexFormat, GLenum usage) {
+    if(quads > MAX_QUADS) {
+        std::cout << "Mesh has " << quads << " quads, only the first " << MAX_QUADS << " will be drawn" << std::endl;
+        quads = MAX_QUADS;
+    }
+    if(vertexBuffer == 0 || vertexFormat != format) {
+        Release();
+        format = vertexFormat;
+        glGenBuffers(1, &vertexBuffer);
+        if(VertexArraysSupported()) {
+            glGenVertexArrays(1, &vertexArray);
+            BindVertexArray(vertexArray);
+            BindVertexLayout(vertexBuffer, format, 0);
+        }
+    }
+    quadCount = quads;
+
+    size_t quadSize = VertexSize(format) * 4;
+    CountVertexBytes(quads * quadSize);
+    BindArrayBuffer(vertexBuffer);
+    if(quads > capacity) {
+        glBufferData(GL_ARRAY_BUFFER, quads * quadSize, vertices, usage);
+        capacity = quads;
+    } else {
+        //orphan the old storage so a draw still reading it doesn't make this wait
+        glBufferData(GL_ARRAY_BUFFER, capacity * quadSize, NULL, usage);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, quads * quadSize, vertices);
+    }
+}
+
+void Mesh::Draw() {
+    if(quadCount == 0) {
+        return;
+    }
+    if(format == VERTEX_TILE) {
+        //a disabled attribute reads this value, it isn't part of the vertex array so it is set every time
+        glVertexAttrib4f(COLOR_ATTRIBUTE, 1.0f, 1.0f, 1.0f, 1.0f);
+    }
+    if(vertexArray != 0) {
+        BindVertexArray(vertexArray);
+    } else {
+        BindVertexLayout(vertexBuffer, format, 0);
+    }
+    DrawQuads(0, quadCount);
+}
+
+void DrawQuads(int firstQuad, int quads) {
+    //quad n starts at index n * 6 of the shared index buffer
+    glDrawElements(GL_TRIANGLES, quads * 6, GL_UNSIGNED_SHORT, (const GLvoid*)(sizeof(GLushort) * 6 * firstQuad));
+    CountDraw(quads * 4, quads * 2);
+}
+
+void Mesh::Release() {
+    if(vertexArray != 0) {
+        DeleteVertexArray(vertexArray);
+        vertexArray = 0;
+    }
+    if(vertexBuffer != 0) {
+        DeleteBuffer(vertexBuffer);
+        vertexBuffer = 0;
+    }
+    quadCount = 0;
+    capacity = 0;
+}
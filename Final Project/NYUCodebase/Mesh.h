@@ -0,0 +1,81 @@
+#pragma once
+
+#include "GLPlatform.h"
+#include <stddef.h>
+#include <vector>
+
+//every quad is four corners drawn through one shared index buffer, 0 1 2 0 2 3 then the same for the next four
+//16 bit indices cap a single draw at MAX_QUADS quads
+#define MAX_QUADS 16384
+
+enum VertexFormat { VERTEX_TILE, VERTEX_SPRITE };
+
+//tiles sit on whole grid positions so the corners fit in 8 bytes, with texCoords as normalized 16 bit
+class TileVertex {
+    public:
+        GLshort x, y;
+        GLushort u, v;
+};
+
+//sprites and text need fractional positions and get a packed rgba tint, 16 bytes a corner
+class SpriteVertex {
+    public:
+        float x, y;
+        GLushort u, v;
+        GLubyte color[4];
+};
+
+//texCoords go from 0 to 1 so they are stored as fractions of 65535
+inline GLushort PackTexCoord(float t) {
+    if(t <= 0.0f) {
+        return 0;
+    }
+    if(t >= 1.0f) {
+        return 65535;
+    }
+    return (GLushort)(t * 65535.0f + 0.5f);
+}
+
+inline float UnpackTexCoord(GLushort t) {
+    return (float)t / 65535.0f;
+}
+
+inline size_t VertexSize(VertexFormat format) {
+    return format == VERTEX_TILE ? sizeof(TileVertex) : sizeof(SpriteVertex);
+}
+
+//fills in the four corners of a quad from its top left and bottom right
+void SetQuad(SpriteVertex *corners, float left, float top, float right, float bottom, float u0, float v0, float u1, float v1);
+
+//points the attributes at a buffer of vertices in the given format, offset is in bytes
+//tile vertices have no color, the attribute is left disabled and reads as white
+void BindVertexLayout(GLuint vertexBuffer, VertexFormat format, size_t offset);
+
+//the shared static index buffer, created the first time it is asked for
+GLuint QuadIndexBuffer();
+void ReleaseQuadIndexBuffer();
+
+//every draw goes through here so it shows up in the frame's RenderStats, the vertex layout has to be bound already
+void DrawQuads(int firstQuad, int quads);
+
+//quads of one vertex format in a buffer object, drawn indexed from the shared index buffer
+//the attribute setup lives in a vertex array object when the context has them and is redone per draw otherwise
+class Mesh {
+    public:
+        Mesh();
+
+        //static meshes are uploaded once, dynamic ones reuse the same buffer and only grow it when needed
+        void Upload(const void *vertices, int quads, VertexFormat vertexFormat, GLenum usage);
+
+        void Draw();
+        //frees the buffer and vertex array, needs the GL context
+        void Release();
+
+        GLuint vertexArray;
+        GLuint vertexBuffer;
+        VertexFormat format;
+        int quadCount;
+
+    private:
+        int capacity;
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+//the indices each side writes get a line to themselves so the producer and consumer don't keep stealing it from each other
+#define CACHE_LINE_SIZE 64
+
+//a bounded ring for exactly one producer thread and one consumer thread, nothing ever blocks
+//each side keeps the last index it read of the other side and only reloads it when the ring looks full or empty
+template <typename T, size_t Capacity>
+class SPSCQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "the capacity has to be a power of two");
+
+    public:
+        SPSCQueue() : head(0), cachedTail(0), tail(0), cachedHead(0) {}
+
+        //producer only, false if the ring is full
+        bool TryPush(const T &value) {
+            size_t position = tail.load(std::memory_order_relaxed);
+            if(position - cachedHead == Capacity) {
+                cachedHead = head.load(std::memory_order_acquire);
+                if(position - cachedHead == Capacity) {
+                    return false;
+                }
+            }
+            slots[position & (Capacity - 1)] = value;
+            tail.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        //consumer only, false if the ring is empty
+        bool TryPop(T &value) {
+            size_t position = head.load(std::memory_order_relaxed);
+            if(position == cachedTail) {
+                cachedTail = tail.load(std::memory_order_acquire);
+                if(position == cachedTail) {
+                    return false;
+                }
+            }
+            value = slots[position & (Capacity - 1)];
+            head.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        //the consumer's line
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> head;
+        size_t cachedTail;
+        //the producer's line
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail;
+        size_t cachedHead;
+
+        alignas(CACHE_LINE_SIZE) T slots[Capacity];
+};
+
+//a bounded ring any number of threads can push to and one thread pops from, nothing ever blocks
+//every slot carries a sequence number saying whose turn it is, producers claim a slot by moving the tail past it
+//and the consumer only reads a slot once its producer has bumped the sequence, so a slow producer can't hand over half a value
+template <typename T, size_t Capacity>
+class MPSCQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "the capacity has to be a power of two");
+
+    public:
+        MPSCQueue() : tail(0), head(0) {
+            for(size_t i = 0; i < Capacity; i++) {
+                slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        //any thread, false if the ring is full
+        bool TryPush(const T &value) {
+            size_t position = tail.load(std::memory_order_relaxed);
+            Slot *slot;
+            while(true) {
+                slot = &slots[position & (Capacity - 1)];
+                intptr_t turn = (intptr_t)slot->sequence.load(std::memory_order_acquire) - (intptr_t)position;
+                if(turn == 0) {
+                    if(tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                else if(turn < 0) {
+                    //the consumer hasn't emptied this slot since the last lap
+                    return false;
+                }
+                else {
+                    //another producer got it first
+                    position = tail.load(std::memory_order_relaxed);
+                }
+            }
+            slot->value = value;
+            slot->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        //consumer only, false if the ring is empty or the oldest slot is still being written
+        bool TryPop(T &value) {
+            Slot &slot = slots[head & (Capacity - 1)];
+            if((intptr_t)slot.sequence.load(std::memory_order_acquire) - (intptr_t)(head + 1) < 0) {
+                return false;
+            }
+            value = slot.value;
+            //free again for the producer that comes around on the next lap
+            slot.sequence.store(head + Capacity, std::memory_order_release);
+            head++;
+            return true;
+        }
+
+    private:
+        class Slot {
+            public:
+                std::atomic<size_t> sequence;
+                T value;
+        };
+
+        //shared by the producers
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail;
+        //the consumer's
+        alignas(CACHE_LINE_SIZE) size_t head;
+
+        alignas(CACHE_LINE_SIZE) Slot slots[Capacity];
+};
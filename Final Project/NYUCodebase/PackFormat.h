@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+
+//layout of an asset pack, shared by the game and tools/packassets.cpp
+//
+//  PackHeader
+//  PackEntry[entryCount]   sorted by name so lookups can binary search the mapped index
+//  blobs                   each one starts on a PACK_ALIGNMENT boundary
+//
+//all numbers are little endian
+
+#define PACK_MAGIC "NYPK"
+#define PACK_VERSION 1
+#define PACK_ALIGNMENT 64
+#define PACK_NAME_LENGTH 48
+
+struct PackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct PackEntry {
+    char name[PACK_NAME_LENGTH];
+    uint64_t offset;
+    uint64_t size;
+};
@@ -0,0 +1,61 @@
+#include "RenderBackend.h"
+#include <string.h>
+#include <iostream>
+
+static RenderBackend currentBackend = RENDER_COMPATIBILITY;
+static bool vertexArrays = false;
+
+RenderBackend ChooseRenderBackend(int argc, char *argv[]) {
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--core") == 0) {
+            return RENDER_CORE;
+        }
+    }
+    return RENDER_COMPATIBILITY;
+}
+
+SDL_GLContext CreateRenderContext(SDL_Window *window, RenderBackend backend) {
+    SDL_GLContext context = NULL;
+    if(backend == RENDER_CORE) {
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+        //macOS only hands out core contexts that are forward compatible
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG);
+        context = SDL_GL_CreateContext(window);
+        if(context == NULL) {
+            std::cout << "Unable to create a core profile context, using the default one: " << SDL_GetError() << std::endl;
+            SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, 0);
+            SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, 0);
+            SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
+            SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 1);
+            backend = RENDER_COMPATIBILITY;
+        }
+    }
+    if(context == NULL) {
+        context = SDL_GL_CreateContext(window);
+    }
+    SDL_GL_MakeCurrent(window, context);
+#ifdef _WINDOWS
+    //glew looks entry points up with glGetString(GL_EXTENSIONS) unless told otherwise, which core contexts don't have
+    glewExperimental = GL_TRUE;
+    glewInit();
+#endif
+
+    currentBackend = backend;
+#ifdef __APPLE__
+    //legacy contexts on macOS only have the APPLE flavour of vertex arrays
+    vertexArrays = (backend == RENDER_CORE);
+#else
+    vertexArrays = (backend == RENDER_CORE) || SDL_GL_ExtensionSupported("GL_ARB_vertex_array_object");
+#endif
+    return context;
+}
+
+RenderBackend CurrentRenderBackend() {
+    return currentBackend;
+}
+
+bool VertexArraysSupported() {
+    return vertexArrays;
+}
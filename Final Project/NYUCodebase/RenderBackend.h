@@ -0,0 +1,19 @@
+#pragma once
+
+#include "GLPlatform.h"
+#include <SDL.h>
+
+enum RenderBackend { RENDER_COMPATIBILITY, RENDER_CORE };
+
+//--core on the command line asks for a 3.3 core profile context instead of the default one
+RenderBackend ChooseRenderBackend(int argc, char *argv[]);
+
+//creates the context for the backend, falls back to the default context if the driver can't make a core one
+SDL_GLContext CreateRenderContext(SDL_Window *window, RenderBackend backend);
+
+//what was actually created, only valid after CreateRenderContext
+RenderBackend CurrentRenderBackend();
+
+//core profiles need a vertex array object bound for every draw, older contexts may not have them at all
+bool VertexArraysSupported();
+
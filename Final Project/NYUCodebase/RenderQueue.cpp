@@ -0,0 +1,297 @@
+#include "RenderQueue.h"
+#include "GLState.h"
+#include "FrameArena.h"
+#include <string.h>
+#include <iostream>
+
+#define MAX_COMMANDS 65536
+
+//eye space z of a layer and depth, later layers and higher depths are closer
+//the projection's near and far are -1 and 1 and this stays well inside them
+static float layerDepth(int layer, int depth) {
+    if(depth > 255) {
+        depth = 255;
+    }
+    return (float)(layer * 256 + depth) / 8192.0f;
+}
+
+static GpuPass layerPass(int layer) {
+    switch(layer) {
+        case LAYER_BACKGROUND:
+            return GPU_PASS_BACKGROUND;
+        case LAYER_TILES_BACK:
+        case LAYER_TILES_FRONT:
+            return GPU_PASS_MAP;
+        case LAYER_UI:
+            return GPU_PASS_TEXT;
+        default:
+            return GPU_PASS_ENTITIES;
+    }
+}
+
+RenderQueue::RenderQueue() : warned(false) {}
+
+bool RenderQueue::hasRoom() {
+    if(commands.size() < MAX_COMMANDS) {
+        return true;
+    }
+    if(!warned) {
+        std::cout << "Render queue is full, dropping commands past " << MAX_COMMANDS << " a frame" << std::endl;
+        warned = true;
+    }
+    return false;
+}
+
+uint64_t RenderQueue::makeKey(AlphaClass alpha, int layer, ShaderProgram *program, GLuint texture, int depth) const {
+    //the depth test only helps if what is in front gets drawn first
+    if(alpha != ALPHA_TRANSLUCENT) {
+        layer = 0x3F - layer;
+        depth = 0xFFFF - depth;
+    }
+    uint64_t key = (uint64_t)alpha << 62;
+    key |= (uint64_t)(layer & 0x3F) << 56;
+    key |= (uint64_t)(program->programID & 0xFF) << 48;
+    key |= (uint64_t)(texture & 0xFFFF) << 32;
+    key |= (uint64_t)(depth & 0xFFFF) << 16;
+    //the command index doubles as a tie breaker that keeps submission order
+    key |= (uint64_t)(commands.size() & 0xFFFF);
+    return key;
+}
+
+void RenderQueue::SubmitQuads(int layer, ShaderProgram *program, GLuint texture, const Matrix &modelview, const SpriteVertex *corners, int quads, int depth) {
+    if(!hasRoom()) {
+        return;
+    }
+    RenderCommand command;
+    command.program = program;
+    command.textures[0] = texture;
+    command.textures[1] = 0;
+    command.firstVertex = (int)vertices.size();
+    command.quadCount = 0;
+    command.mesh = NULL;
+    command.layer = layer;
+    command.depth = depth;
+    command.alpha = ALPHA_OPAQUE;
+
+    for(int i = 0; i < quads * 4; i += 4) {
+        //cut the quad down to the part of its frame that isn't clear, fully clear ones like spaces are dropped
+        //corners come from SetQuad, so 0 is the top left and 2 the bottom right
+        float u0 = UnpackTexCoord(corners[i].u);
+        float v0 = UnpackTexCoord(corners[i].v);
+        float u1 = UnpackTexCoord(corners[i + 2].u);
+        float v1 = UnpackTexCoord(corners[i + 2].v);
+        float trimmedU0 = u0, trimmedV0 = v0, trimmedU1 = u1, trimmedV1 = v1;
+        if(!TrimTextureRegion(texture, trimmedU0, trimmedV0, trimmedU1, trimmedV1)) {
+            continue;
+        }
+        SpriteVertex quad[4];
+        for(int j = 0; j < 4; j++) {
+            quad[j] = corners[i + j];
+        }
+        if(u1 != u0 && v1 != v0) {
+            float left = corners[i].x, top = corners[i].y, right = corners[i + 2].x, bottom = corners[i + 2].y;
+            float trimmedLeft = left + (right - left) * (trimmedU0 - u0) / (u1 - u0);
+            float trimmedRight = left + (right - left) * (trimmedU1 - u0) / (u1 - u0);
+            float trimmedTop = top + (bottom - top) * (trimmedV0 - v0) / (v1 - v0);
+            float trimmedBottom = top + (bottom - top) * (trimmedV1 - v0) / (v1 - v0);
+            float xs[4] = {trimmedLeft, trimmedLeft, trimmedRight, trimmedRight};
+            float ys[4] = {trimmedTop, trimmedBottom, trimmedBottom, trimmedTop};
+            float us[4] = {trimmedU0, trimmedU0, trimmedU1, trimmedU1};
+            float vs[4] = {trimmedV0, trimmedV1, trimmedV1, trimmedV0};
+            for(int j = 0; j < 4; j++) {
+                quad[j].x = xs[j];
+                quad[j].y = ys[j];
+                quad[j].u = PackTexCoord(us[j]);
+                quad[j].v = PackTexCoord(vs[j]);
+            }
+        }
+
+        AlphaClass alpha = TextureRegionAlpha(texture, trimmedU0, trimmedV0, trimmedU1, trimmedV1);
+        for(int j = 0; j < 4; j++) {
+            if(quad[j].color[3] != 255) {
+                alpha = ALPHA_TRANSLUCENT;
+            }
+        }
+        command.alpha = WorstAlphaClass(command.alpha, alpha);
+
+        //the shader then only has the projection left to apply
+        for(int j = 0; j < 4; j++) {
+            SpriteVertex corner = quad[j];
+            corner.x = modelview.m[0][0] * quad[j].x + modelview.m[1][0] * quad[j].y + modelview.m[3][0];
+            corner.y = modelview.m[0][1] * quad[j].x + modelview.m[1][1] * quad[j].y + modelview.m[3][1];
+            vertices.push_back(corner);
+        }
+        command.quadCount++;
+    }
+    if(command.quadCount == 0) {
+        return;
+    }
+    keys.push_back(makeKey(command.alpha, layer, program, texture, depth));
+    commands.push_back(command);
+}
+
+void RenderQueue::SubmitText(int layer, ShaderProgram *program, GLuint fontTexture, const Matrix &modelview, const char *text, float size, float spacing, int depth) {
+    float texture_size = 1.0/16.0f;
+    int length = (int)strlen(text);
+    FrameVector<SpriteVertex> corners(length * 4);
+    for(int i=0; i < length; i++) {
+        int spriteIndex = (int)text[i];
+        float texture_x = (float)(spriteIndex % 16) / 16.0f;
+        float texture_y = (float)(spriteIndex / 16) / 16.0f;
+        float left = ((size+spacing) * i) + (-0.5f * size);
+        float right = ((size+spacing) * i) + (0.5f * size);
+        SetQuad(&corners[i * 4], left, 0.5f * size, right, -0.5f * size, texture_x, texture_y, texture_x + texture_size, texture_y + texture_size);
+    }
+    SubmitQuads(layer, program, fontTexture, modelview, corners.data(), length, depth);
+}
+
+void RenderQueue::SubmitMesh(int layer, ShaderProgram *program, GLuint texture, GLuint secondTexture, const Matrix &modelview, Mesh *mesh, AlphaClass alpha, int depth) {
+    if(!hasRoom()) {
+        return;
+    }
+    RenderCommand command;
+    command.program = program;
+    command.textures[0] = texture;
+    command.textures[1] = secondTexture;
+    command.firstVertex = 0;
+    command.quadCount = 0;
+    command.mesh = mesh;
+    command.modelview = modelview;
+    command.layer = layer;
+    command.depth = depth;
+    command.alpha = alpha;
+    keys.push_back(makeKey(alpha, layer, program, texture, depth));
+    commands.push_back(command);
+}
+
+int RenderQueue::CommandCount() const {
+    return (int)commands.size();
+}
+
+//least significant byte first, each pass is a stable counting sort so earlier passes are kept as ties
+void RenderQueue::sortKeys() {
+    sortBuffer.resize(keys.size());
+    for(int shift = 0; shift < 64; shift += 8) {
+        size_t counts[257] = {0};
+        for(size_t i = 0; i < keys.size(); i++) {
+            counts[((keys[i] >> shift) & 0xFF) + 1]++;
+        }
+        //every key has the same byte here, nothing would move
+        if(counts[((keys[0] >> shift) & 0xFF) + 1] == keys.size()) {
+            continue;
+        }
+        for(int i = 0; i < 256; i++) {
+            counts[i + 1] += counts[i];
+        }
+        for(size_t i = 0; i < keys.size(); i++) {
+            sortBuffer[counts[(keys[i] >> shift) & 0xFF]++] = keys[i];
+        }
+        keys.swap(sortBuffer);
+    }
+}
+
+void RenderQueue::beginPass(AlphaClass alpha) {
+    SetDepthTest(true);
+    if(alpha == ALPHA_TRANSLUCENT) {
+        //still tested against the opaque pixels, but they must not hide each other
+        SetBlend(true);
+        SetDepthWrite(false);
+    } else {
+        SetBlend(false);
+        SetDepthWrite(true);
+    }
+}
+
+void RenderQueue::Flush(StreamBuffer &stream, GpuProfiler *profiler) {
+    if(commands.empty()) {
+        return;
+    }
+    sortKeys();
+
+    //lay the quads out in draw order so neighbouring commands with the same state are one range
+    sortedVertices.clear();
+    for(size_t i = 0; i < keys.size(); i++) {
+        RenderCommand &command = commands[keys[i] & 0xFFFF];
+        if(command.mesh == NULL) {
+            int first = (int)sortedVertices.size();
+            sortedVertices.insert(sortedVertices.end(), vertices.begin() + command.firstVertex, vertices.begin() + command.firstVertex + command.quadCount * 4);
+            command.firstVertex = first;
+        }
+    }
+    //quads past what the stream can take this frame are the only ones dropped, they are last in draw order
+    int streamedQuad = 0;
+    int streamedQuads = 0;
+    if(!sortedVertices.empty()) {
+        int quads = (int)sortedVertices.size() / 4;
+        streamedQuads = quads < stream.Room() ? quads : stream.Room();
+        streamedQuad = stream.Write(sortedVertices);
+    }
+
+    //texels under the threshold are discarded, for translucent commands that skips blending what is fully clear
+    const float alphaTest[ALPHA_CLASS_COUNT] = {0.0f, 0.5f, 1.0f / 255.0f};
+
+    int pass = -1;
+    int gpuPass = -1;
+    size_t i = 0;
+    while(i < keys.size()) {
+        RenderCommand &command = commands[keys[i] & 0xFFFF];
+        if(command.alpha != pass) {
+            pass = command.alpha;
+            beginPass(command.alpha);
+        }
+        if(profiler != NULL && layerPass(command.layer) != gpuPass) {
+            gpuPass = layerPass(command.layer);
+            profiler->Begin((GpuPass)gpuPass);
+        }
+        UseProgram(command.program->programID);
+        command.program->SetAlphaTest(alphaTest[command.alpha]);
+        if(command.textures[1] != 0) {
+            ActiveTexture(1);
+            BindTexture(command.textures[1]);
+        }
+        ActiveTexture(0);
+        BindTexture(command.textures[0]);
+
+        if(command.mesh != NULL) {
+            command.modelview.m[3][2] = layerDepth(command.layer, command.depth);
+            command.program->SetModelviewMatrix(command.modelview);
+            command.mesh->Draw();
+            i++;
+            continue;
+        }
+
+        //merge the run of quad commands that share program and texture
+        int quads = command.quadCount;
+        size_t next = i + 1;
+        while(next < keys.size()) {
+            RenderCommand &other = commands[keys[next] & 0xFFFF];
+            if(other.mesh != NULL || other.program != command.program || other.textures[0] != command.textures[0] ||
+               other.alpha != command.alpha || other.layer != command.layer || other.depth != command.depth) {
+                break;
+            }
+            quads += other.quadCount;
+            next++;
+        }
+        Matrix modelview;
+        modelview.m[3][2] = layerDepth(command.layer, command.depth);
+        command.program->SetModelviewMatrix(modelview);
+        int first = command.firstVertex / 4;
+        if(first + quads > streamedQuads) {
+            quads = streamedQuads - first;
+        }
+        if(streamedQuad >= 0 && quads > 0) {
+            stream.Draw(streamedQuad + first, quads);
+        }
+        i = next;
+    }
+
+    if(profiler != NULL) {
+        profiler->End();
+    }
+    //glClear only clears depth where writing is on
+    SetDepthWrite(true);
+
+    commands.clear();
+    vertices.clear();
+    keys.clear();
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "GLPlatform.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "Matrix.h"
+#include "Mesh.h"
+#include "ShaderProgram.h"
+#include "StreamBuffer.h"
+#include "TextureAlpha.h"
+#include "GpuProfiler.h"
+
+//layers stack in this order, inside a layer commands are grouped by shader then texture then depth
+enum RenderLayer { LAYER_BACKGROUND, LAYER_TILES_BACK, LAYER_ENTITIES, LAYER_PLAYER, LAYER_TILES_FRONT, LAYER_UI };
+
+//one draw, either quads the queue keeps until Flush() or a mesh that already lives on the GPU
+class RenderCommand {
+    public:
+        ShaderProgram *program;
+        //unit 0 and 1, 0 leaves the unit alone
+        GLuint textures[2];
+
+        int firstVertex;
+        int quadCount;
+
+        Mesh *mesh;
+        Matrix modelview;
+
+        int layer;
+        int depth;
+        AlphaClass alpha;
+};
+
+//gameplay and UI submit commands here during the frame and nothing touches GL until Flush()
+//each command gets a 64 bit key, alpha class 2 bits | layer 6 | shader 8 | texture 16 | depth 16 | submission order 16,
+//the keys are radix sorted so state changes are grouped and same texture quads become one draw
+//opaque and alpha tested commands go first, front to back with blending off so the depth test rejects hidden pixels,
+//then only the translucent ones are blended back to front
+class RenderQueue {
+    public:
+        RenderQueue();
+
+        //quads are trimmed to the visible part of their frame and moved into view space here,
+        //so sprites with different matrices can still share a draw
+        //their alpha class comes from the part of the texture they still cover
+        void SubmitQuads(int layer, ShaderProgram *program, GLuint texture, const Matrix &modelview, const SpriteVertex *corners, int quads, int depth = 0);
+        //the corners are built in the frame arena, so text costs no heap allocations
+        void SubmitText(int layer, ShaderProgram *program, GLuint fontTexture, const Matrix &modelview, const char *text, float size, float spacing, int depth = 0);
+        void SubmitMesh(int layer, ShaderProgram *program, GLuint texture, GLuint secondTexture, const Matrix &modelview, Mesh *mesh, AlphaClass alpha, int depth = 0);
+
+        //sorts, streams every quad in one write and issues the draws, then empties the queue
+        //the profiler, if there is one, times the layers as background, map, entities and text
+        void Flush(StreamBuffer &stream, GpuProfiler *profiler = NULL);
+
+        int CommandCount() const;
+
+    private:
+        uint64_t makeKey(AlphaClass alpha, int layer, ShaderProgram *program, GLuint texture, int depth) const;
+        void beginPass(AlphaClass alpha);
+        void sortKeys();
+        //false when the command has to be dropped, says so once rather than every frame
+        bool hasRoom();
+
+        std::vector<RenderCommand> commands;
+        std::vector<SpriteVertex> vertices;
+        std::vector<uint64_t> keys;
+
+        std::vector<uint64_t> sortBuffer;
+        std::vector<SpriteVertex> sortedVertices;
+        bool warned;
+};
@@ -0,0 +1,115 @@
+#include "RenderStats.h"
+
+static RenderStats current;
+static RenderStats last;
+
+static StatHistogram drawCallHistogram;
+static StatHistogram vertexHistogram;
+static StatHistogram triangleHistogram;
+static StatHistogram textureBindHistogram;
+static StatHistogram programSwitchHistogram;
+static StatHistogram uniformUploadHistogram;
+static StatHistogram vertexByteHistogram;
+
+RenderStats::RenderStats() {
+    Clear();
+}
+
+void RenderStats::Clear() {
+    drawCalls = 0;
+    vertices = 0;
+    triangles = 0;
+    textureBinds = 0;
+    programSwitches = 0;
+    uniformUploads = 0;
+    vertexBytes = 0;
+}
+
+StatHistogram::StatHistogram() : count(0), sum(0.0), minimum(0), maximum(0) {
+    for(int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        buckets[i] = 0;
+    }
+}
+
+void StatHistogram::Add(size_t value) {
+    int bucket = 0;
+    for(size_t rest = value; rest != 0 && bucket < HISTOGRAM_BUCKETS - 1; rest >>= 1) {
+        bucket++;
+    }
+    buckets[bucket]++;
+    if(count == 0 || value < minimum) {
+        minimum = value;
+    }
+    if(count == 0 || value > maximum) {
+        maximum = value;
+    }
+    count++;
+    sum += (double)value;
+}
+
+void StatHistogram::Print(std::ostream &out, const char *name) const {
+    if(count == 0) {
+        return;
+    }
+    out << name << ": min " << minimum << " max " << maximum << " average " << sum / count << " over " << count << " frames" << std::endl;
+    for(int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        if(buckets[i] == 0) {
+            continue;
+        }
+        size_t low = i == 0 ? 0 : (size_t)1 << (i - 1);
+        size_t high = i == 0 ? 0 : ((size_t)1 << i) - 1;
+        out << "    " << low << "-" << high << ": " << buckets[i] << " (" << 100.0 * buckets[i] / count << "%)" << std::endl;
+    }
+}
+
+void CountDraw(int vertices, int triangles) {
+    current.drawCalls++;
+    current.vertices += vertices;
+    current.triangles += triangles;
+}
+
+void CountTextureBind() {
+    current.textureBinds++;
+}
+
+void CountProgramSwitch() {
+    current.programSwitches++;
+}
+
+void CountUniformUpload() {
+    current.uniformUploads++;
+}
+
+void CountVertexBytes(size_t bytes) {
+    current.vertexBytes += bytes;
+}
+
+RenderStats& CurrentRenderStats() {
+    return current;
+}
+
+const RenderStats& LastRenderStats() {
+    return last;
+}
+
+void EndRenderStatsFrame() {
+    drawCallHistogram.Add(current.drawCalls);
+    vertexHistogram.Add(current.vertices);
+    triangleHistogram.Add(current.triangles);
+    textureBindHistogram.Add(current.textureBinds);
+    programSwitchHistogram.Add(current.programSwitches);
+    uniformUploadHistogram.Add(current.uniformUploads);
+    vertexByteHistogram.Add(current.vertexBytes);
+    last = current;
+    current.Clear();
+}
+
+void PrintRenderStatsHistograms(std::ostream &out) {
+    drawCallHistogram.Print(out, "Draw calls");
+    vertexHistogram.Print(out, "Vertices");
+    triangleHistogram.Print(out, "Triangles");
+    textureBindHistogram.Print(out, "Texture binds");
+    programSwitchHistogram.Print(out, "Program switches");
+    uniformUploadHistogram.Print(out, "Uniform uploads");
+    vertexByteHistogram.Print(out, "Vertex bytes");
+}
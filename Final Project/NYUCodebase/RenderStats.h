@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stddef.h>
+#include <ostream>
+
+//what one frame asked of GL, counted by the wrappers every draw, bind and upload goes through
+class RenderStats {
+    public:
+        RenderStats();
+        void Clear();
+
+        int drawCalls;
+        int vertices;
+        int triangles;
+        int textureBinds;
+        int programSwitches;
+        int uniformUploads;
+        //vertex data written to buffer objects, streamed sprites and text plus mesh uploads
+        size_t vertexBytes;
+};
+
+//buckets are powers of two, bucket n holds values from 2^(n-1) up to 2^n - 1 and bucket 0 holds zero
+#define HISTOGRAM_BUCKETS 24
+
+//every frame since the start, so a change in submission work shows up as the whole distribution moving
+class StatHistogram {
+    public:
+        StatHistogram();
+
+        void Add(size_t value);
+        void Print(std::ostream &out, const char *name) const;
+
+        size_t buckets[HISTOGRAM_BUCKETS];
+        size_t count;
+        double sum;
+        size_t minimum;
+        size_t maximum;
+};
+
+//only ever the main thread, like the GL calls being counted
+void CountDraw(int vertices, int triangles);
+void CountTextureBind();
+void CountProgramSwitch();
+void CountUniformUpload();
+void CountVertexBytes(size_t bytes);
+
+//the frame being counted right now
+RenderStats& CurrentRenderStats();
+//the last finished frame
+const RenderStats& LastRenderStats();
+//adds the frame to the histograms and starts counting the next one
+void EndRenderStatsFrame();
+void PrintRenderStatsHistograms(std::ostream &out);
@@ -1,5 +1,9 @@
 
 #include "ShaderProgram.h"
+#include "AssetPack.h"
+#include "GLState.h"
+#include "RenderStats.h"
+#include <string.h>
 
 ShaderProgram::ShaderProgram(const char *vertexShaderFile, const char *fragmentShaderFile) {
     
@@ -12,6 +16,9 @@ ShaderProgram::ShaderProgram(const char *vertexShaderFile, const char *fragmentS
     programID = glCreateProgram();
     glAttachShader(programID, vertexShader);
     glAttachShader(programID, fragmentShader);
+    glBindAttribLocation(programID, POSITION_ATTRIBUTE, "position");
+    glBindAttribLocation(programID, TEXCOORD_ATTRIBUTE, "texCoord");
+    glBindAttribLocation(programID, COLOR_ATTRIBUTE, "color");
     glLinkProgram(programID);
     
     GLint linkSuccess;
@@ -22,21 +29,29 @@ ShaderProgram::ShaderProgram(const char *vertexShaderFile, const char *fragmentS
     
     modelviewMatrixUniform = glGetUniformLocation(programID, "modelviewMatrix");
     projectionMatrixUniform = glGetUniformLocation(programID, "projectionMatrix");
+    alphaTestUniform = glGetUniformLocation(programID, "alphaTest");
     
     positionAttribute = glGetAttribLocation(programID, "position");
     texCoordAttribute = glGetAttribLocation(programID, "texCoord");
     
+    resetShadows();
 }
 
-ShaderProgram::ShaderProgram() {};
+ShaderProgram::ShaderProgram() : alphaTestUniform(-1), modelviewSet(false), projectionSet(false), alphaTestSet(false) {};
 
 ShaderProgram::~ShaderProgram() {
-    glDeleteProgram(programID);
+    DeleteProgram(programID);
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
 }
 
 GLuint ShaderProgram::LoadShaderFromFile(const std::string &shaderFile, GLenum type) {
+    //Compile straight out of the asset pack if there is one
+    AssetSpan span;
+    if(FindAsset(shaderFile, span)) {
+        return LoadShaderFromMemory((const char*)span.data, (GLint)span.size, type);
+    }
+    
     //Open a file stream with the file name
     std::ifstream infile(shaderFile);
     
@@ -53,15 +68,15 @@ GLuint ShaderProgram::LoadShaderFromFile(const std::string &shaderFile, GLenum t
 }
 
 GLuint ShaderProgram::LoadShaderFromString(const std::string &shaderContents, GLenum type) {
-    
+    // Get the pointer to the C string from the STL string
+    return LoadShaderFromMemory(shaderContents.c_str(), (GLint) shaderContents.size(), type);
+}
+
+GLuint ShaderProgram::LoadShaderFromMemory(const char *shaderString, GLint shaderStringLength, GLenum type) {
     
     // Create a shader of specified type
     GLuint shaderID = glCreateShader(type);
     
-    // Get the pointer to the C string from the STL string
-    const char *shaderString = shaderContents.c_str();
-    GLint shaderStringLength = (GLint) shaderContents.size();
-    
     // Set the shader source to the string and compile shader
     glShaderSource(shaderID, 1, &shaderString, &shaderStringLength);
     glCompileShader(shaderID);
@@ -82,12 +97,146 @@ GLuint ShaderProgram::LoadShaderFromString(const std::string &shaderContents, GL
 }
 
 
+// Swaps in a newly compiled program, keeps the old one if the new sources don't compile or link
+bool ShaderProgram::Reload(const std::string &vertexShaderContents, const std::string &fragmentShaderContents) {
+    GLuint newVertexShader = LoadShaderFromString(vertexShaderContents, GL_VERTEX_SHADER);
+    GLuint newFragmentShader = LoadShaderFromString(fragmentShaderContents, GL_FRAGMENT_SHADER);
+    
+    GLuint newProgramID = glCreateProgram();
+    glAttachShader(newProgramID, newVertexShader);
+    glAttachShader(newProgramID, newFragmentShader);
+    glBindAttribLocation(newProgramID, POSITION_ATTRIBUTE, "position");
+    glBindAttribLocation(newProgramID, TEXCOORD_ATTRIBUTE, "texCoord");
+    glBindAttribLocation(newProgramID, COLOR_ATTRIBUTE, "color");
+    glLinkProgram(newProgramID);
+    
+    GLint linkSuccess;
+    glGetProgramiv(newProgramID, GL_LINK_STATUS, &linkSuccess);
+    if(linkSuccess == GL_FALSE) {
+        printf("Error linking shader program, keeping the old one!\n");
+        glDeleteProgram(newProgramID);
+        glDeleteShader(newVertexShader);
+        glDeleteShader(newFragmentShader);
+        return false;
+    }
+    
+    DeleteProgram(programID);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    
+    programID = newProgramID;
+    vertexShader = newVertexShader;
+    fragmentShader = newFragmentShader;
+    
+    modelviewMatrixUniform = glGetUniformLocation(programID, "modelviewMatrix");
+    projectionMatrixUniform = glGetUniformLocation(programID, "projectionMatrix");
+    alphaTestUniform = glGetUniformLocation(programID, "alphaTest");
+    
+    positionAttribute = glGetAttribLocation(programID, "position");
+    texCoordAttribute = glGetAttribLocation(programID, "texCoord");
+    
+    //the new program starts with all its uniforms at zero
+    resetShadows();
+    return true;
+}
+
+void ShaderProgram::resetShadows() {
+    modelviewSet = false;
+    projectionSet = false;
+    alphaTestSet = false;
+    uniforms.clear();
+}
+
+bool ShaderProgram::sameMatrix(Matrix &shadow, bool &set, const Matrix &matrix) {
+    if(set && memcmp(shadow.ml, matrix.ml, sizeof(matrix.ml)) == 0) {
+        CountStateCall(true);
+        return true;
+    }
+    shadow = matrix;
+    set = true;
+    CountStateCall(false);
+    return false;
+}
+
 void ShaderProgram::SetModelviewMatrix(const Matrix &matrix) {
-    glUseProgram(programID);
-    glUniformMatrix4fv(modelviewMatrixUniform, 1, GL_FALSE, matrix.ml);
+    UseProgram(programID);
+    if(!sameMatrix(modelviewShadow, modelviewSet, matrix)) {
+        glUniformMatrix4fv(modelviewMatrixUniform, 1, GL_FALSE, matrix.ml);
+        CountUniformUpload();
+    }
 }
 
 void ShaderProgram::SetProjectionMatrix(const Matrix &matrix) {
-    glUseProgram(programID);
-    glUniformMatrix4fv(projectionMatrixUniform, 1, GL_FALSE, matrix.ml);    
+    UseProgram(programID);
+    if(!sameMatrix(projectionShadow, projectionSet, matrix)) {
+        glUniformMatrix4fv(projectionMatrixUniform, 1, GL_FALSE, matrix.ml);
+        CountUniformUpload();
+    }
+}
+
+ShaderProgram::UniformShadow& ShaderProgram::uniform(const std::string &name) {
+    std::map<std::string, UniformShadow>::iterator found = uniforms.find(name);
+    if(found != uniforms.end()) {
+        return found->second;
+    }
+    UniformShadow &shadow = uniforms[name];
+    shadow.location = glGetUniformLocation(programID, name.c_str());
+    shadow.set = false;
+    return shadow;
+}
+
+void ShaderProgram::SetUniform(const std::string &name, int value) {
+    UseProgram(programID);
+    UniformShadow &shadow = uniform(name);
+    if(shadow.set && shadow.values[0] == (float)value) {
+        CountStateCall(true);
+        return;
+    }
+    glUniform1i(shadow.location, value);
+    CountUniformUpload();
+    shadow.values[0] = (float)value;
+    shadow.set = true;
+    CountStateCall(false);
+}
+
+void ShaderProgram::SetUniform(const std::string &name, float value) {
+    UseProgram(programID);
+    UniformShadow &shadow = uniform(name);
+    if(shadow.set && shadow.values[0] == value) {
+        CountStateCall(true);
+        return;
+    }
+    glUniform1f(shadow.location, value);
+    CountUniformUpload();
+    shadow.values[0] = value;
+    shadow.set = true;
+    CountStateCall(false);
+}
+
+void ShaderProgram::SetAlphaTest(float value) {
+    UseProgram(programID);
+    if(alphaTestSet && alphaTestShadow == value) {
+        CountStateCall(true);
+        return;
+    }
+    glUniform1f(alphaTestUniform, value);
+    CountUniformUpload();
+    alphaTestShadow = value;
+    alphaTestSet = true;
+    CountStateCall(false);
+}
+
+void ShaderProgram::SetUniform(const std::string &name, float x, float y) {
+    UseProgram(programID);
+    UniformShadow &shadow = uniform(name);
+    if(shadow.set && shadow.values[0] == x && shadow.values[1] == y) {
+        CountStateCall(true);
+        return;
+    }
+    glUniform2f(shadow.location, x, y);
+    CountUniformUpload();
+    shadow.values[0] = x;
+    shadow.values[1] = y;
+    shadow.set = true;
+    CountStateCall(false);
 }
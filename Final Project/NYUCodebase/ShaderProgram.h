@@ -1,35 +1,68 @@
 #pragma once
 
-#ifdef _WINDOWS
-	#include <GL/glew.h>
-#endif
-#include <SDL_opengl.h>
+#include "GLPlatform.h"
 #include <string>
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <map>
 #include "Matrix.h"
 
+//every program gets the same attribute slots so one vertex array layout works with all of them
+#define POSITION_ATTRIBUTE 0
+#define TEXCOORD_ATTRIBUTE 1
+#define COLOR_ATTRIBUTE 2
+
 class ShaderProgram {
     public:
         ShaderProgram(const char *vertexShaderFile, const char *fragmentShaderFile);
         ShaderProgram();
         ~ShaderProgram();
     
+        //these make the program current and only send values that differ from the last ones sent
         void SetModelviewMatrix(const Matrix &matrix);
         void SetProjectionMatrix(const Matrix &matrix);
+        void SetUniform(const std::string &name, int value);
+        void SetUniform(const std::string &name, float value);
+        void SetUniform(const std::string &name, float x, float y);
+        //every command of a flush sets this, so it skips the by-name lookup the other uniforms go through
+        void SetAlphaTest(float value);
     
         GLuint LoadShaderFromString(const std::string &shaderContents, GLenum type);
+        GLuint LoadShaderFromMemory(const char *shaderContents, GLint shaderLength, GLenum type);
         GLuint LoadShaderFromFile(const std::string &shaderFile, GLenum type);
     
+        bool Reload(const std::string &vertexShaderContents, const std::string &fragmentShaderContents);
+    
         GLuint programID;
     
         GLuint projectionMatrixUniform;
         GLuint modelviewMatrixUniform;
+        GLint alphaTestUniform;
     
         GLuint positionAttribute;
         GLuint texCoordAttribute;
     
         GLuint vertexShader;
         GLuint fragmentShader;
+    
+    private:
+        class UniformShadow {
+            public:
+                GLint location;
+                float values[2];
+                bool set;
+        };
+    
+        void resetShadows();
+        UniformShadow& uniform(const std::string &name);
+        bool sameMatrix(Matrix &shadow, bool &set, const Matrix &matrix);
+    
+        Matrix modelviewShadow;
+        Matrix projectionShadow;
+        bool modelviewSet;
+        bool projectionSet;
+        float alphaTestShadow;
+        bool alphaTestSet;
+        std::map<std::string, UniformShadow> uniforms;
 };
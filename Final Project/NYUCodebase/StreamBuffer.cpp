@@ -0,0 +1,133 @@
+#include "StreamBuffer.h"
+#include "GLState.h"
+#include "RenderBackend.h"
+#include "RenderStats.h"
+#include <string.h>
+#include <iostream>
+
+StreamBuffer::StreamBuffer() : usePersistentMapping(false), frameQuads(0), regions(1), vertexBuffer(0), mapped(NULL),
+frame(0), used(0), warned(false) {
+    for(int i = 0; i < STREAM_FRAMES; i++) {
+        vertexArrays[i] = 0;
+        fences[i] = 0;
+    }
+}
+
+void StreamBuffer::Init(int quads) {
+    frameQuads = quads < MAX_QUADS ? quads : MAX_QUADS;
+#ifdef GL_MAP_PERSISTENT_BIT
+    usePersistentMapping = SDL_GL_ExtensionSupported("GL_ARB_buffer_storage") && SDL_GL_ExtensionSupported("GL_ARB_sync");
+#endif
+    regions = usePersistentMapping ? STREAM_FRAMES : 1;
+    size_t regionSize = sizeof(SpriteVertex) * 4 * frameQuads;
+
+    glGenBuffers(1, &vertexBuffer);
+    BindArrayBuffer(vertexBuffer);
+    if(usePersistentMapping) {
+#ifdef GL_MAP_PERSISTENT_BIT
+        //mapped once for the life of the game, coherent so nothing has to be flushed before a draw
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, regionSize * regions, NULL, flags);
+        mapped = (SpriteVertex*)glMapBufferRange(GL_ARRAY_BUFFER, 0, regionSize * regions, flags);
+#endif
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, regionSize, NULL, GL_STREAM_DRAW);
+    }
+
+    if(VertexArraysSupported()) {
+        for(int i = 0; i < regions; i++) {
+            glGenVertexArrays(1, &vertexArrays[i]);
+            BindVertexArray(vertexArrays[i]);
+            BindVertexLayout(vertexBuffer, VERTEX_SPRITE, regionSize * i);
+        }
+    }
+}
+
+void StreamBuffer::Release() {
+    for(int i = 0; i < STREAM_FRAMES; i++) {
+        if(fences[i] != 0) {
+            glDeleteSync(fences[i]);
+            fences[i] = 0;
+        }
+        if(vertexArrays[i] != 0) {
+            DeleteVertexArray(vertexArrays[i]);
+            vertexArrays[i] = 0;
+        }
+    }
+    if(vertexBuffer != 0) {
+        //deleting a buffer unmaps it
+        DeleteBuffer(vertexBuffer);
+        vertexBuffer = 0;
+        mapped = NULL;
+    }
+}
+
+void StreamBuffer::BeginFrame() {
+    used = 0;
+    if(usePersistentMapping) {
+        frame = (frame + 1) % STREAM_FRAMES;
+        //written STREAM_FRAMES frames ago, so this is almost always signalled already
+        if(fences[frame] != 0) {
+            glClientWaitSync(fences[frame], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ULL);
+            glDeleteSync(fences[frame]);
+            fences[frame] = 0;
+        }
+    } else {
+        //hands the old storage to the driver to free once the GPU is done with it, so writing never waits
+        BindArrayBuffer(vertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(SpriteVertex) * 4 * frameQuads, NULL, GL_STREAM_DRAW);
+    }
+}
+
+void StreamBuffer::EndFrame() {
+    if(usePersistentMapping) {
+        fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+int StreamBuffer::Write(const SpriteVertex *corners, int quads) {
+    if(used + quads > frameQuads) {
+        if(!warned) {
+            std::cout << "Stream buffer is out of room, skipping draws past " << frameQuads << " quads a frame" << std::endl;
+            warned = true;
+        }
+        quads = frameQuads - used;
+        if(quads <= 0) {
+            return -1;
+        }
+    }
+
+    int first = used;
+    CountVertexBytes(sizeof(SpriteVertex) * 4 * quads);
+    if(usePersistentMapping) {
+        memcpy(mapped + (frame * frameQuads + first) * 4, corners, sizeof(SpriteVertex) * 4 * quads);
+    } else {
+        //only ever writes the part of this frame's storage no draw has used yet
+        BindArrayBuffer(vertexBuffer);
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(SpriteVertex) * 4 * first, sizeof(SpriteVertex) * 4 * quads, corners);
+    }
+    used += quads;
+    return first;
+}
+
+int StreamBuffer::Write(const std::vector<SpriteVertex> &corners) {
+    return Write(corners.data(), (int)corners.size() / 4);
+}
+
+int StreamBuffer::Room() const {
+    return frameQuads - used;
+}
+
+void StreamBuffer::Draw(int firstQuad, int quads) {
+    if(firstQuad < 0 || quads == 0) {
+        return;
+    }
+    int region = usePersistentMapping ? frame : 0;
+    if(vertexArrays[region] != 0) {
+        BindVertexArray(vertexArrays[region]);
+    } else {
+        BindVertexLayout(vertexBuffer, VERTEX_SPRITE, sizeof(SpriteVertex) * 4 * frameQuads * region);
+    }
+    //quad n of the region lines up with quad n of the shared index buffer
+    DrawQuads(firstQuad, quads);
+}
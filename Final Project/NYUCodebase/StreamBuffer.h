@@ -0,0 +1,48 @@
+#pragma once
+
+#include "GLPlatform.h"
+#include <SDL.h>
+#include <vector>
+#include "Mesh.h"
+
+#define STREAM_FRAMES 3
+
+//per-frame quad allocator for geometry that changes every draw, like text and sprites
+//one buffer split into a region per frame in flight, written through a persistent mapping when
+//GL_ARB_buffer_storage is there, with a fence per region so the CPU only writes what the GPU is done with
+//without it the buffer is one region that gets orphaned at the start of every frame instead
+class StreamBuffer {
+    public:
+        StreamBuffer();
+
+        //needs the GL context, frameQuads is how many quads one frame can stream, at most MAX_QUADS
+        void Init(int frameQuads);
+        void Release();
+
+        //call around everything drawn in a frame
+        void BeginFrame();
+        void EndFrame();
+
+        //copies four corners per quad in and returns the first quad to draw, -1 if the frame is out of room
+        //only the first Room() quads are written when there are more, the rest are dropped
+        int Write(const SpriteVertex *corners, int quads);
+        int Write(const std::vector<SpriteVertex> &corners);
+        //quads this frame can still take
+        int Room() const;
+        void Draw(int firstQuad, int quads);
+
+    private:
+        bool usePersistentMapping;
+        int frameQuads;
+        int regions;
+
+        GLuint vertexBuffer;
+        //each region gets its own vertex array so the shared index buffer can address it from zero
+        GLuint vertexArrays[STREAM_FRAMES];
+        SpriteVertex *mapped;
+        GLsync fences[STREAM_FRAMES];
+
+        int frame;
+        int used;
+        bool warned;
+};
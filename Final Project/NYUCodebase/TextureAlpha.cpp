@@ -0,0 +1,132 @@
+#include "TextureAlpha.h"
+#include "Mesh.h"
+#include <utility>
+#include <math.h>
+
+static std::map<GLuint, AlphaMap> textureAlpha;
+
+AlphaClass WorstAlphaClass(AlphaClass a, AlphaClass b) {
+    return a > b ? a : b;
+}
+
+AlphaMap::AlphaMap() : width(0), height(0) {}
+
+void AlphaMap::Build(const unsigned char *pixels, int width, int height) {
+    this->width = width;
+    this->height = height;
+    //one extra row and column of zeros so every lookup stays in bounds
+    int stride = width + 1;
+    notSolid.assign((size_t)stride * (height + 1), 0);
+    partial.assign((size_t)stride * (height + 1), 0);
+    visible.assign((size_t)stride * (height + 1), 0);
+    trimmed.clear();
+    for(int y = 0; y < height; y++) {
+        uint32_t rowNotSolid = 0;
+        uint32_t rowPartial = 0;
+        uint32_t rowVisible = 0;
+        for(int x = 0; x < width; x++) {
+            unsigned char alpha = pixels[((size_t)y * width + x) * 4 + 3];
+            rowNotSolid += alpha != 255;
+            rowPartial += alpha != 255 && alpha != 0;
+            rowVisible += alpha != 0;
+            size_t index = (size_t)(y + 1) * stride + x + 1;
+            notSolid[index] = notSolid[index - stride] + rowNotSolid;
+            partial[index] = partial[index - stride] + rowPartial;
+            visible[index] = visible[index - stride] + rowVisible;
+        }
+    }
+}
+
+uint32_t AlphaMap::area(const std::vector<uint32_t> &table, int x0, int y0, int x1, int y1) const {
+    int stride = width + 1;
+    return table[(size_t)y1 * stride + x1] - table[(size_t)y0 * stride + x1] - table[(size_t)y1 * stride + x0] + table[(size_t)y0 * stride + x0];
+}
+
+//every texel the rectangle touches, a little too many is fine since it can only make the class worse
+void AlphaMap::texelBounds(float u0, float v0, float u1, float v1, int &x0, int &y0, int &x1, int &y1) const {
+    x0 = (int)floorf(fminf(u0, u1) * width);
+    x1 = (int)ceilf(fmaxf(u0, u1) * width);
+    y0 = (int)floorf(fminf(v0, v1) * height);
+    y1 = (int)ceilf(fmaxf(v0, v1) * height);
+    x0 = x0 < 0 ? 0 : (x0 > width ? width : x0);
+    x1 = x1 < 0 ? 0 : (x1 > width ? width : x1);
+    y0 = y0 < 0 ? 0 : (y0 > height ? height : y0);
+    y1 = y1 < 0 ? 0 : (y1 > height ? height : y1);
+}
+
+AlphaClass AlphaMap::Classify(float u0, float v0, float u1, float v1) const {
+    if(width == 0 || height == 0) {
+        return ALPHA_TRANSLUCENT;
+    }
+    int x0, y0, x1, y1;
+    texelBounds(u0, v0, u1, v1, x0, y0, x1, y1);
+
+    if(area(partial, x0, y0, x1, y1) > 0) {
+        return ALPHA_TRANSLUCENT;
+    }
+    if(area(notSolid, x0, y0, x1, y1) > 0) {
+        return ALPHA_TESTED;
+    }
+    return ALPHA_OPAQUE;
+}
+
+bool AlphaMap::Trim(float &u0, float &v0, float &u1, float &v1) const {
+    //flipped rectangles are left alone
+    if(width == 0 || height == 0 || u0 > u1 || v0 > v1) {
+        return true;
+    }
+    uint64_t key = (uint64_t)PackTexCoord(u0) << 48 | (uint64_t)PackTexCoord(v0) << 32 | (uint64_t)PackTexCoord(u1) << 16 | PackTexCoord(v1);
+    std::map<uint64_t, TrimmedRegion>::const_iterator found = trimmed.find(key);
+    if(found == trimmed.end()) {
+        TrimmedRegion region;
+        int x0, y0, x1, y1;
+        texelBounds(u0, v0, u1, v1, x0, y0, x1, y1);
+        region.visible = area(visible, x0, y0, x1, y1) > 0;
+        if(region.visible) {
+            //walk each edge in while the row or column under it is completely clear
+            while(area(visible, x0, y0, x0 + 1, y1) == 0) {
+                x0++;
+            }
+            while(area(visible, x1 - 1, y0, x1, y1) == 0) {
+                x1--;
+            }
+            while(area(visible, x0, y0, x1, y0 + 1) == 0) {
+                y0++;
+            }
+            while(area(visible, x0, y1 - 1, x1, y1) == 0) {
+                y1--;
+            }
+        }
+        //the trimmed edges are texel edges, but never outside the cell that was asked for
+        region.u0 = fmaxf(u0, (float)x0 / width);
+        region.v0 = fmaxf(v0, (float)y0 / height);
+        region.u1 = fminf(u1, (float)x1 / width);
+        region.v1 = fminf(v1, (float)y1 / height);
+        found = trimmed.insert(std::make_pair(key, region)).first;
+    }
+    u0 = found->second.u0;
+    v0 = found->second.v0;
+    u1 = found->second.u1;
+    v1 = found->second.v1;
+    return found->second.visible;
+}
+
+void SetTextureAlpha(GLuint texture, AlphaMap &map) {
+    std::swap(textureAlpha[texture], map);
+}
+
+AlphaClass TextureRegionAlpha(GLuint texture, float u0, float v0, float u1, float v1) {
+    std::map<GLuint, AlphaMap>::const_iterator found = textureAlpha.find(texture);
+    if(found == textureAlpha.end()) {
+        return ALPHA_TRANSLUCENT;
+    }
+    return found->second.Classify(u0, v0, u1, v1);
+}
+
+bool TrimTextureRegion(GLuint texture, float &u0, float &v0, float &u1, float &v1) {
+    std::map<GLuint, AlphaMap>::const_iterator found = textureAlpha.find(texture);
+    if(found == textureAlpha.end()) {
+        return true;
+    }
+    return found->second.Trim(u0, v0, u1, v1);
+}
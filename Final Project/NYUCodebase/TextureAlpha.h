@@ -0,0 +1,54 @@
+#pragma once
+
+#include "GLPlatform.h"
+#include <stdint.h>
+#include <vector>
+#include <map>
+
+//how a region of a texture has to be drawn, ordered from cheapest to most expensive
+//opaque needs no blending, alpha tested only has fully clear or fully solid texels so a discard is enough
+enum AlphaClass { ALPHA_OPAQUE, ALPHA_TESTED, ALPHA_TRANSLUCENT };
+#define ALPHA_CLASS_COUNT 3
+
+AlphaClass WorstAlphaClass(AlphaClass a, AlphaClass b);
+
+//summed area tables of the texels that aren't fully solid, the ones that are partly see-through and the ones that aren't fully clear,
+//so any rectangle of the texture is classified with eight lookups
+//Build() only reads the pixels and can run on a worker thread
+class AlphaMap {
+    public:
+        AlphaMap();
+
+        void Build(const unsigned char *pixels, int width, int height);
+        AlphaClass Classify(float u0, float v0, float u1, float v1) const;
+        //shrinks the rectangle to the texels that can be seen, false if there are none
+        //sprites ask for the same few frames over and over so the answers are kept
+        bool Trim(float &u0, float &v0, float &u1, float &v1) const;
+
+        int width;
+        int height;
+
+    private:
+        class TrimmedRegion {
+            public:
+                bool visible;
+                float u0, v0, u1, v1;
+        };
+
+        uint32_t area(const std::vector<uint32_t> &table, int x0, int y0, int x1, int y1) const;
+        void texelBounds(float u0, float v0, float u1, float v1, int &x0, int &y0, int &x1, int &y1) const;
+
+        std::vector<uint32_t> notSolid;
+        std::vector<uint32_t> partial;
+        std::vector<uint32_t> visible;
+
+        mutable std::map<uint64_t, TrimmedRegion> trimmed;
+};
+
+//the maps of every loaded texture, filled in by whatever uploads the pixels
+//main thread only, like the textures themselves
+void SetTextureAlpha(GLuint texture, AlphaMap &map);
+//textures that were never classified count as translucent, that is always safe to draw
+AlphaClass TextureRegionAlpha(GLuint texture, float u0, float v0, float u1, float v1);
+//unclassified textures are left as they are
+bool TrimTextureRegion(GLuint texture, float &u0, float &v0, float &u1, float &v1);
@@ -0,0 +1,149 @@
+#include "TextureCache.h"
+#include "AssetPack.h"
+#include "stb_image.h"
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+#define CACHE_MAGIC "NYTC"
+#define CACHE_VERSION 1
+
+struct CacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceHash;
+    uint32_t width;
+    uint32_t height;
+};
+
+//FNV-1a, hashing the PNG is a small fraction of the cost of decoding it
+static uint64_t hashBytes(const unsigned char *data, size_t size) {
+    uint64_t hash = 14695981039346656037ULL;
+    for(size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static std::string prefFolder() {
+    std::string folder;
+    char *prefPath = SDL_GetPrefPath("NYU", "SpaceBoy");
+    if(prefPath != NULL) {
+        folder = prefPath;
+        SDL_free(prefPath);
+    }
+    return folder;
+}
+
+static const std::string& cacheFolder() {
+    static std::string folder = prefFolder();
+    return folder;
+}
+
+static std::string cacheFile(const std::string &path) {
+    size_t slash = path.find_last_of("/\\");
+    return cacheFolder() + (slash == std::string::npos ? path : path.substr(slash + 1)) + ".rgba";
+}
+
+static unsigned char* readCache(const std::string &file, uint64_t sourceHash, int *width, int *height) {
+    FILE *cached = fopen(file.c_str(), "rb");
+    if(cached == NULL) {
+        return NULL;
+    }
+    CacheHeader header;
+    unsigned char *pixels = NULL;
+    if(fread(&header, sizeof(header), 1, cached) == 1 && memcmp(header.magic, CACHE_MAGIC, 4) == 0 &&
+       header.version == CACHE_VERSION && header.sourceHash == sourceHash) {
+        size_t size = (size_t)header.width * header.height * 4;
+        //a truncated or corrupt entry must not get to ask for any amount of memory, the pixels have to be exactly the rest of the file
+        long pixelsStart = ftell(cached);
+        long fileEnd = -1;
+        if(pixelsStart >= 0 && fseek(cached, 0, SEEK_END) == 0) {
+            fileEnd = ftell(cached);
+        }
+        if(fileEnd < 0 || header.width == 0 || header.height == 0 || (uint64_t)header.width * header.height * 4 != (uint64_t)(fileEnd - pixelsStart) ||
+           fseek(cached, pixelsStart, SEEK_SET) != 0) {
+            fclose(cached);
+            return NULL;
+        }
+        //same allocator as stb_image so both kinds of image are freed the same way
+        pixels = (unsigned char*)malloc(size);
+        if(pixels != NULL && fread(pixels, 1, size, cached) != size) {
+            free(pixels);
+            pixels = NULL;
+        } else if(pixels != NULL) {
+            *width = (int)header.width;
+            *height = (int)header.height;
+        }
+    }
+    fclose(cached);
+    return pixels;
+}
+
+static void writeCache(const std::string &file, uint64_t sourceHash, const unsigned char *pixels, int width, int height) {
+    //written next to the real entry and renamed over it so a crash never leaves half an entry behind
+    std::string temporary = file + ".tmp";
+    FILE *cached = fopen(temporary.c_str(), "wb");
+    if(cached == NULL) {
+        return;
+    }
+    CacheHeader header;
+    memcpy(header.magic, CACHE_MAGIC, 4);
+    header.version = CACHE_VERSION;
+    header.sourceHash = sourceHash;
+    header.width = (uint32_t)width;
+    header.height = (uint32_t)height;
+    size_t size = (size_t)width * height * 4;
+    bool written = fwrite(&header, sizeof(header), 1, cached) == 1 && fwrite(pixels, 1, size, cached) == size;
+    fclose(cached);
+    if(!written) {
+        remove(temporary.c_str());
+        return;
+    }
+    remove(file.c_str());
+    rename(temporary.c_str(), file.c_str());
+}
+
+unsigned char* LoadCachedImage(const std::string &path, int *width, int *height, bool looseOnly) {
+    //the source bytes come straight from the asset pack when there is one
+    AssetSpan span;
+    std::string looseContents;
+    if(looseOnly || !FindAsset(path, span)) {
+        std::ifstream infile(path, std::ios::binary);
+        if(infile.fail()) {
+            return NULL;
+        }
+        std::stringstream buffer;
+        buffer << infile.rdbuf();
+        looseContents = buffer.str();
+        span.data = (const unsigned char*)looseContents.data();
+        span.size = looseContents.size();
+    }
+
+    uint64_t sourceHash = hashBytes(span.data, span.size);
+    bool cacheAvailable = cacheFolder() != "";
+    if(cacheAvailable) {
+        unsigned char *pixels = readCache(cacheFile(path), sourceHash, width, height);
+        if(pixels != NULL) {
+            return pixels;
+        }
+    }
+
+    int comp;
+    unsigned char *pixels = stbi_load_from_memory(span.data, (int)span.size, width, height, &comp, STBI_rgb_alpha);
+    if(pixels != NULL && cacheAvailable) {
+        writeCache(cacheFile(path), sourceHash, pixels, *width, *height);
+    }
+    return pixels;
+}
+
+void FreeCachedImage(unsigned char *pixels) {
+    stbi_image_free(pixels);
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+
+//decodes images through an on-disk cache of the decoded RGBA pixels
+//entries are keyed by a hash of the source file, so a changed PNG is decoded again and everything else skips stb_image
+//safe to call from several threads at once, as long as they load different files
+//hot reload passes looseOnly, the mounted pack still has the bytes from before the edit
+unsigned char* LoadCachedImage(const std::string &path, int *width, int *height, bool looseOnly = false);
+void FreeCachedImage(unsigned char *pixels);
@@ -0,0 +1,223 @@
+#include "TextureUploader.h"
+#include "GLState.h"
+#include "TextureCache.h"
+#include <string.h>
+
+TextureUploader::TextureUploader() : usePixelBuffers(false), usePersistentMapping(false), useFences(false), slotSize(0), nextSlot(0) {
+    for(int i = 0; i < UPLOAD_SLOTS; i++) {
+        slots[i].buffer = 0;
+        slots[i].offset = 0;
+        slots[i].mapped = NULL;
+        slots[i].fence = 0;
+        slots[i].texture = 0;
+    }
+}
+
+TextureUploader::~TextureUploader() {
+    for(size_t i = 0; i < queue.size(); i++) {
+        FreeCachedImage(queue[i].pixels);
+    }
+}
+
+void TextureUploader::Init(size_t size) {
+    slotSize = size;
+    usePixelBuffers = SDL_GL_ExtensionSupported("GL_ARB_pixel_buffer_object") && SDL_GL_ExtensionSupported("GL_ARB_map_buffer_range");
+    useFences = SDL_GL_ExtensionSupported("GL_ARB_sync");
+#ifdef GL_MAP_PERSISTENT_BIT
+    usePersistentMapping = usePixelBuffers && useFences && SDL_GL_ExtensionSupported("GL_ARB_buffer_storage");
+#endif
+    if(!usePixelBuffers) {
+        return;
+    }
+
+    if(usePersistentMapping) {
+#ifdef GL_MAP_PERSISTENT_BIT
+        //one buffer split into slots, mapped once for the life of the game
+        GLuint buffer;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_PIXEL_UNPACK_BUFFER, slotSize * UPLOAD_SLOTS, NULL, flags);
+        unsigned char *mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, slotSize * UPLOAD_SLOTS, flags);
+        for(int i = 0; i < UPLOAD_SLOTS; i++) {
+            slots[i].buffer = buffer;
+            slots[i].offset = slotSize * i;
+            slots[i].mapped = mapped + slotSize * i;
+        }
+#endif
+    } else {
+        for(int i = 0; i < UPLOAD_SLOTS; i++) {
+            glGenBuffers(1, &slots[i].buffer);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slots[i].buffer);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, slotSize, NULL, GL_STREAM_DRAW);
+        }
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+GLuint TextureUploader::Queue(unsigned char *pixels, int width, int height) {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    BindTexture(texture);
+    //allocating the storage without pixels is cheap, the rows arrive over the next frames
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    QueueInto(texture, pixels, width, height);
+    return texture;
+}
+
+void TextureUploader::QueueInto(GLuint texture, unsigned char *pixels, int width, int height) {
+    GLint currentWidth = 0;
+    GLint currentHeight = 0;
+    BindTexture(texture);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &currentWidth);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &currentHeight);
+    if(currentWidth != width || currentHeight != height) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    }
+
+    //a newer version of a texture that hasn't started uploading yet just replaces the old pixels
+    for(size_t i = 0; i < queue.size(); i++) {
+        if(queue[i].texture == texture && queue[i].nextRow == 0 && queue[i].width == width && queue[i].height == height) {
+            FreeCachedImage(queue[i].pixels);
+            queue[i].pixels = pixels;
+            return;
+        }
+    }
+
+    Upload upload;
+    upload.texture = texture;
+    upload.pixels = pixels;
+    upload.width = width;
+    upload.height = height;
+    upload.nextRow = 0;
+    queue.push_back(upload);
+    unissued.insert(texture);
+}
+
+bool TextureUploader::IsReady(GLuint texture) const {
+    if(unissued.count(texture) > 0) {
+        return false;
+    }
+    std::map<GLuint, int>::const_iterator bands = inFlight.find(texture);
+    return bands == inFlight.end() || bands->second == 0;
+}
+
+//frees the slots the GPU has finished reading from
+void TextureUploader::retire(bool wait) {
+    for(int i = 0; i < UPLOAD_SLOTS; i++) {
+        if(slots[i].fence == 0) {
+            continue;
+        }
+        GLenum status = glClientWaitSync(slots[i].fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? 1000000000ULL : 0);
+        if(status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+            glDeleteSync(slots[i].fence);
+            slots[i].fence = 0;
+            if(--inFlight[slots[i].texture] == 0) {
+                inFlight.erase(slots[i].texture);
+            }
+        }
+    }
+}
+
+void TextureUploader::issue(Slot &slot, Upload &upload, int rows) {
+    size_t rowBytes = (size_t)upload.width * 4;
+    size_t bytes = rowBytes * rows;
+    const unsigned char *source = upload.pixels + rowBytes * upload.nextRow;
+    BindTexture(upload.texture);
+
+    if(!usePixelBuffers) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, upload.nextRow, upload.width, rows, GL_RGBA, GL_UNSIGNED_BYTE, source);
+        return;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+    if(usePersistentMapping) {
+        memcpy(slot.mapped, source, bytes);
+    } else {
+        //the slot's fence has passed (or the driver tracks it for us), so the old contents can be thrown away
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+        if(useFences) {
+            flags |= GL_MAP_UNSYNCHRONIZED_BIT;
+        }
+        void *mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, flags);
+        memcpy(mapped, source, bytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, upload.nextRow, upload.width, rows, GL_RGBA, GL_UNSIGNED_BYTE, (const GLvoid*)slot.offset);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if(useFences) {
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slot.texture = upload.texture;
+        inFlight[upload.texture]++;
+    }
+}
+
+void TextureUploader::Update(size_t byteBudget) {
+    if(useFences) {
+        retire(false);
+    }
+
+    int slotsTried = 0;
+    while(!queue.empty() && slotsTried < UPLOAD_SLOTS) {
+        Slot &slot = slots[nextSlot];
+        nextSlot = (nextSlot + 1) % UPLOAD_SLOTS;
+        slotsTried++;
+        if(slot.fence != 0) {
+            //still being read by the GPU, try again next frame instead of waiting on it
+            continue;
+        }
+
+        Upload &upload = queue.front();
+        size_t rowBytes = (size_t)upload.width * 4;
+        size_t budget = byteBudget < slotSize || !usePixelBuffers ? byteBudget : slotSize;
+        int rows = (int)(budget / rowBytes);
+        if(rows < 1) {
+            rows = 1;
+        }
+        if(rows > upload.height - upload.nextRow) {
+            rows = upload.height - upload.nextRow;
+        }
+        if(usePixelBuffers && rowBytes * rows > slotSize) {
+            //a single row wider than a slot, send it straight from client memory
+            BindTexture(upload.texture);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, upload.nextRow, upload.width, rows, GL_RGBA, GL_UNSIGNED_BYTE, upload.pixels + rowBytes * upload.nextRow);
+        } else {
+            issue(slot, upload, rows);
+        }
+        upload.nextRow += rows;
+
+        if(upload.nextRow >= upload.height) {
+            GLuint texture = upload.texture;
+            FreeCachedImage(upload.pixels);
+            queue.pop_front();
+            bool queuedAgain = false;
+            for(size_t i = 0; i < queue.size(); i++) {
+                queuedAgain = queuedAgain || queue[i].texture == texture;
+            }
+            if(!queuedAgain) {
+                unissued.erase(texture);
+            }
+        }
+
+        size_t spent = rowBytes * rows;
+        if(spent >= byteBudget) {
+            break;
+        }
+        byteBudget -= spent;
+    }
+}
+
+void TextureUploader::Finish() {
+    while(!queue.empty()) {
+        Update(slotSize);
+        if(useFences) {
+            retire(true);
+        }
+    }
+    if(useFences) {
+        retire(true);
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "GLPlatform.h"
+#include <SDL.h>
+#include <deque>
+#include <map>
+#include <set>
+
+#define UPLOAD_SLOTS 3
+
+//streams texture uploads through pixel buffer objects a few rows at a time so a big texture never stalls a frame
+//the staging memory is persistently mapped when GL_ARB_buffer_storage is there and mapped per upload otherwise,
+//fences tell when the GPU is done reading a slot so it can be written again
+class TextureUploader {
+    public:
+        TextureUploader();
+        ~TextureUploader();
+
+        //needs the GL context, slotSize is how many bytes one slot can stage per frame
+        void Init(size_t slotSize);
+
+        //the returned texture can be bound right away but only has its pixels once IsReady() says so
+        //takes ownership of pixels, which have to come from LoadCachedImage
+        GLuint Queue(unsigned char *pixels, int width, int height);
+        void QueueInto(GLuint texture, unsigned char *pixels, int width, int height);
+        bool IsReady(GLuint texture) const;
+
+        //call once per frame, issues at most byteBudget bytes of new uploads
+        void Update(size_t byteBudget);
+        //blocks until everything queued has been uploaded
+        void Finish();
+
+    private:
+        class Upload {
+            public:
+                GLuint texture;
+                unsigned char *pixels;
+                int width;
+                int height;
+                int nextRow;
+        };
+
+        class Slot {
+            public:
+                GLuint buffer;
+                size_t offset;
+                unsigned char *mapped;
+                GLsync fence;
+                GLuint texture;
+        };
+
+        void retire(bool wait);
+        void issue(Slot &slot, Upload &upload, int rows);
+
+        bool usePixelBuffers;
+        bool usePersistentMapping;
+        bool useFences;
+        size_t slotSize;
+
+        Slot slots[UPLOAD_SLOTS];
+        int nextSlot;
+
+        std::deque<Upload> queue;
+        std::set<GLuint> unissued;
+        std::map<GLuint, int> inFlight;
+};
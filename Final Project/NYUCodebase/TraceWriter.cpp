@@ -0,0 +1,55 @@
+#include "TraceWriter.h"
+#include <iostream>
+
+TraceWriter::TraceWriter() : file(NULL), firstEvent(true), origin(0) {}
+
+TraceWriter::~TraceWriter() {
+    Close();
+}
+
+bool TraceWriter::Open(const std::string &path) {
+    Close();
+    file = fopen(path.c_str(), "w");
+    if(file == NULL) {
+        std::cout << "Unable to open trace file " << path << std::endl;
+        return false;
+    }
+    fputs("{\"traceEvents\":[\n", file);
+    firstEvent = true;
+    origin = SDL_GetPerformanceCounter();
+    nameThread(TRACE_THREAD_MAIN, "main");
+    nameThread(TRACE_THREAD_GPU, "GPU");
+    nameThread(TRACE_THREAD_SIMULATION, "simulation");
+    return true;
+}
+
+void TraceWriter::Close() {
+    if(file == NULL) {
+        return;
+    }
+    fputs("\n]}\n", file);
+    fclose(file);
+    file = NULL;
+}
+
+bool TraceWriter::IsOpen() const {
+    return file != NULL;
+}
+
+double TraceWriter::Now() const {
+    return (double)(SDL_GetPerformanceCounter() - origin) * 1000000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+void TraceWriter::nameThread(int thread, const char *name) {
+    fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", firstEvent ? "" : ",\n", thread, name);
+    firstEvent = false;
+}
+
+void TraceWriter::Complete(const char *name, int thread, double start, double duration) {
+    if(file == NULL) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(writeLock);
+    fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.1f,\"dur\":%.1f}", firstEvent ? "" : ",\n", name, thread, start, duration);
+    firstEvent = false;
+}
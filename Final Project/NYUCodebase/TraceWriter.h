@@ -0,0 +1,36 @@
+#pragma once
+
+#include <SDL.h>
+#include <stdio.h>
+#include <string>
+#include <mutex>
+
+//tracks in the trace, each shows up as its own row
+#define TRACE_THREAD_MAIN 1
+#define TRACE_THREAD_GPU 2
+#define TRACE_THREAD_SIMULATION 3
+
+//writes timed events in the Chrome trace format as they happen, open the file in chrome://tracing or Perfetto
+//events can come from any thread, open and close it while only the main thread is running
+class TraceWriter {
+    public:
+        TraceWriter();
+        ~TraceWriter();
+
+        bool Open(const std::string &path);
+        void Close();
+        bool IsOpen() const;
+
+        //microseconds since Open()
+        double Now() const;
+        //an event that started at start and lasted duration, both in microseconds
+        void Complete(const char *name, int thread, double start, double duration);
+
+    private:
+        void nameThread(int thread, const char *name);
+
+        std::mutex writeLock;
+        FILE *file;
+        bool firstEvent;
+        Uint64 origin;
+};
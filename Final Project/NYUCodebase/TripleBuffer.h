@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+
+//hands whole values from one writer thread to one reader thread without locks, neither side ever waits
+//the writer fills its own slot and swaps it for the middle one, the reader swaps the middle one for its own when it is newer
+//so the reader always has the newest finished value and the writer never overwrites the one being read
+template <typename T>
+class TripleBuffer {
+    public:
+        TripleBuffer() : back(0), middle(1), front(2) {}
+
+        //writer thread only, holds whatever was swapped out so every field has to be written again
+        T& Back() {
+            return slots[back];
+        }
+        void Publish() {
+            back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+        }
+
+        //reader thread only, true if a newer value was published since the last call
+        bool Acquire() {
+            if((middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+                return false;
+            }
+            front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+            return true;
+        }
+        const T& Front() const {
+            return slots[front];
+        }
+
+    private:
+        enum { INDEX = 3, FRESH = 4 };
+
+        T slots[3];
+        int back;
+        std::atomic<int> middle;
+        int front;
+};
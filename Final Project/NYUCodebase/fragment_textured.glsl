@@ -1,7 +1,14 @@
 
 uniform sampler2D diffuse;
+//anything less opaque than this is thrown away, set by the render queue for each pass
+uniform float alphaTest;
 varying vec2 texCoordVar;
+varying vec4 colorVar;
 
 void main() {
-    gl_FragColor = texture2D(diffuse, texCoordVar);
+    vec4 color = texture2D(diffuse, texCoordVar) * colorVar;
+    if(color.a < alphaTest) {
+        discard;
+    }
+    gl_FragColor = color;
 }
\ No newline at end of file
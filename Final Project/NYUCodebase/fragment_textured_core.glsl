@@ -0,0 +1,17 @@
+#version 330 core
+
+uniform sampler2D diffuse;
+//anything less opaque than this is thrown away, set by the render queue for each pass
+uniform float alphaTest;
+in vec2 texCoordVar;
+in vec4 colorVar;
+
+out vec4 fragColor;
+
+void main() {
+    vec4 color = texture(diffuse, texCoordVar) * colorVar;
+    if(color.a < alphaTest) {
+        discard;
+    }
+    fragColor = color;
+}
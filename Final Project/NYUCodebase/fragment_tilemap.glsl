@@ -0,0 +1,28 @@
+
+uniform sampler2D diffuse;
+uniform sampler2D tileIndex;
+uniform vec2 mapSize;
+uniform vec2 sheetSize;
+uniform float alphaTest;
+
+varying vec2 texCoordVar;
+varying vec4 colorVar;
+
+void main() {
+    vec2 tilePosition = texCoordVar * mapSize;
+    vec2 cell = clamp(floor(tilePosition), vec2(0.0), mapSize - 1.0);
+    
+    //the id is split over two 8 bit channels, low byte in luminance and high byte in alpha
+    vec4 packedId = texture2D(tileIndex, (cell + 0.5) / mapSize);
+    float tile = floor(packedId.r * 255.0 + 0.5) + floor(packedId.a * 255.0 + 0.5) * 256.0;
+    if(tile == 0.0) {
+        discard;
+    }
+    
+    vec2 sheetCell = vec2(mod(tile, sheetSize.x), floor(tile / sheetSize.x));
+    vec4 color = texture2D(diffuse, (sheetCell + fract(tilePosition)) / sheetSize) * colorVar;
+    if(color.a < alphaTest) {
+        discard;
+    }
+    gl_FragColor = color;
+}
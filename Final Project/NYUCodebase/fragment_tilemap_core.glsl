@@ -0,0 +1,30 @@
+#version 330 core
+
+uniform sampler2D diffuse;
+uniform usampler2D tileIndex;
+uniform vec2 mapSize;
+uniform vec2 sheetSize;
+uniform float alphaTest;
+
+in vec2 texCoordVar;
+in vec4 colorVar;
+
+out vec4 fragColor;
+
+void main() {
+    vec2 tilePosition = texCoordVar * mapSize;
+    ivec2 cell = clamp(ivec2(floor(tilePosition)), ivec2(0), ivec2(mapSize) - 1);
+    
+    uint tile = texelFetch(tileIndex, cell, 0).r;
+    if(tile == 0u) {
+        discard;
+    }
+    
+    uint columns = uint(sheetSize.x);
+    vec2 sheetCell = vec2(float(tile % columns), float(tile / columns));
+    vec4 color = texture(diffuse, (sheetCell + fract(tilePosition)) / sheetSize) * colorVar;
+    if(color.a < alphaTest) {
+        discard;
+    }
+    fragColor = color;
+}
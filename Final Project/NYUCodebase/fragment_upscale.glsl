@@ -0,0 +1,21 @@
+
+uniform sampler2D diffuse;
+//the part of the texture that was drawn into and the whole of it
+uniform vec2 sourceSize;
+uniform vec2 textureSize;
+//window pixels per source pixel
+uniform vec2 scale;
+
+varying vec2 texCoordVar;
+varying vec4 colorVar;
+
+void main() {
+    //sharp bilinear, the middle of each source pixel samples only that pixel
+    //and the linear filter only blends across the last half window pixel at its edges
+    vec2 texel = texCoordVar * sourceSize;
+    vec2 center = fract(texel) - 0.5;
+    vec2 region = 0.5 - 0.5 / scale;
+    vec2 offset = (center - clamp(center, -region, region)) * scale + 0.5;
+    //kept off the edge so nothing outside the drawn part bleeds in
+    gl_FragColor = texture2D(diffuse, clamp(floor(texel) + offset, vec2(0.5), sourceSize - 0.5) / textureSize);
+}
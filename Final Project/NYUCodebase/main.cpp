@@ -1,12 +1,37 @@
-#ifdef _WINDOWS
-#include <GL/glew.h>
-#endif
+#include "GLPlatform.h"
 #include <SDL.h>
-#include <SDL_opengl.h>
 #include <SDL_image.h>
 #include <SDL_mixer.h>
 #include "Matrix.h"
 #include "ShaderProgram.h"
+#include "Level.h"
+#include "LevelManager.h"
+#include "HotReload.h"
+#include "AssetPack.h"
+#include "AssetLoader.h"
+#include "TextureUploader.h"
+#include "RenderBackend.h"
+#include "RenderQueue.h"
+#include "LowResTarget.h"
+#include "DynamicResolution.h"
+#include "GpuProfiler.h"
+#include "TraceWriter.h"
+#include "RenderStats.h"
+#include "GoldenImage.h"
+#include "TripleBuffer.h"
+#include "JobSystem.h"
+#include "Benchmarks.h"
+#include "AudioThread.h"
+#include "FrameArena.h"
+#include "AllocationCounter.h"
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include "Mesh.h"
+#include "StreamBuffer.h"
+#include "GLState.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #include <vector>
@@ -24,17 +49,10 @@ using namespace std;
 
 #define PI 3.14159265359
 #define FIXED_TIMESTEP 0.0166666f
-#define TILE_SIZE 1.0f
-#define SPRITE_COUNT_X 16
-#define SPRITE_COUNT_Y 8
-#define mapHeight 25
-#define mapWidth 90
 
 SDL_Window* displayWindow;
 ShaderProgram program;
 
-void createMap(string input);
-
 GLuint sheet;
 GLuint psheet;
 GLuint esheet;
@@ -43,13 +61,12 @@ GLuint fontTexture;
 GLuint bg;
 
 Mix_Chunk* jump;
-Mix_Chunk* select;
-Mix_Music* music1;
-Mix_Music* music2;
-Mix_Music* music3;
+Mix_Chunk* selectSound;
 Mix_Music* win;
 Mix_Music* lose;
 Mix_Music* menu;
+//the simulation posts what happened and this thread picks the sounds and music for it
+AudioThread audio;
 
 
 vector<int> solids;
@@ -67,18 +84,84 @@ float timer = 0.0;
 
 
 Matrix viewMatrix;
-Matrix mapModelMatrix;
-Matrix mapMVM;
+//the view the last simulation step started from, frames are drawn between it and viewMatrix
+Matrix previousViewMatrix;
+//--sim-rate 30 steps the simulation less often, frames in between are interpolated so movement stays smooth
+float simulationStep = FIXED_TIMESTEP;
 
 enum GameMode { STATE_MAIN_MENU, STATE_GAME_OVER, STATE_GAME_LEVEL1, STATE_GAME_LEVEL2, STATE_GAME_LEVEL3, STATE_GAME_WIN, STATE_MANUAL, STATE_PAUSE};
 
 enum EntityType {ENTITY_PLAYER, ENTITY_ENEMY, ENTITY_GOAL};
 
 GameMode mode = STATE_MAIN_MENU;
+//where Escape and Space return to from the pause menu
+GameMode pausedMode = STATE_MAIN_MENU;
+
+//the movement keys held down, the main thread reads the keyboard and the simulation thread moves the player with them
+enum HeldKey { HELD_LEFT = 1, HELD_RIGHT = 2, HELD_UP = 4 };
+std::atomic<int> heldKeys(0);
+
+LevelManager levels;
+TextureUploader textureUploader;
+
+//sprites and text change every draw and are streamed, the background never changes
+StreamBuffer streamBuffer;
+Mesh backgroundMesh;
+
+//everything drawn in a frame is submitted here and sorted before it reaches GL
+RenderQueue renderQueue;
+
+//the scene is drawn at 320x180 and scaled up to the window, --full-res draws straight to the window instead
+LowResTarget lowResTarget;
+ShaderProgram *upscaleProgram = NULL;
+//shrinks the low resolution target when frames run over 60fps worth of time, --fixed-res keeps it at 320x180
+DynamicResolution dynamicResolution;
+bool dynamicResolutionEnabled = false;
+
+//F3 shows the GPU time of each pass, --trace file.json writes CPU and GPU timings for chrome://tracing
+GpuProfiler gpuProfiler;
+TraceWriter trace;
+bool showProfiler = false;
+
+//set with --tile-shader, the levels are drawn through the tilemap shader instead of their tile meshes
+ShaderProgram *tileMapProgram = NULL;
+
+bool hasArgument(int argc, char *argv[], const char *name) {
+    for(int i = 1; i < argc; i++) {
+        if(string(argv[i]) == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//the argument after name, NULL if it isn't there
+const char* argumentValue(int argc, char *argv[], const char *name) {
+    for(int i = 1; i + 1 < argc; i++) {
+        if(string(argv[i]) == name) {
+            return argv[i + 1];
+        }
+    }
+    return NULL;
+}
 
+void submitLevel(Level *level, const Matrix &view, bool foreground) {
+    if(tileMapProgram != NULL) {
+        level->SubmitTileMap(renderQueue, tileMapProgram, sheet, view, foreground);
+    } else {
+        level->Submit(renderQueue, &program, sheet, view, foreground);
+    }
+}
 
-int levelData[25][90];
 
+//the simulation only ever translates, so blending the translations blends the whole matrix
+Matrix interpolateTranslation(const Matrix &previous, const Matrix &current, float t) {
+    Matrix result = current;
+    for(int i = 0; i < 3; i++) {
+        result.m[3][i] = previous.m[3][i] + (current.m[3][i] - previous.m[3][i]) * t;
+    }
+    return result;
+}
 
 float lerp(float v0, float v1, float t) {
     return (1.0 - t)*v0 + t*v1;
@@ -89,23 +172,6 @@ void worldToTileCoordinates(float worldX, float worldY, int *gridX, int *gridY)
     *gridY = (int)(-worldY / TILE_SIZE);
 }
 
-GLuint LoadTexture(const char *filePath) {
-    int w,h,comp;
-    unsigned char* image = stbi_load(filePath, &w, &h, &comp, STBI_rgb_alpha);
-    if(image == NULL) {
-        std::cout << "Unable to load image. Make sure the path is correct\n";
-        assert(false);
-    }
-    GLuint retTexture;
-    glGenTextures(1, &retTexture);
-    glBindTexture(GL_TEXTURE_2D, retTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    stbi_image_free(image);
-    return retTexture;
-}
-
 class Vector3 {
 public:
     Vector3(){}
@@ -115,6 +181,9 @@ public:
     float z;
 };
 
+//the character sheets are laid out differently from the tile sheet, both are 7 frames across
+enum CharacterSheet { PLAYER_SHEET, ENEMY_SHEET };
+
 class SheetSprite {
 public:
     SheetSprite(){}
@@ -129,25 +198,16 @@ public:
         size = TILE_SIZE;
     };
     
-    SheetSprite(GLuint tID, int idx, string playerID) : textureID(tID), index(idx) {
+    SheetSprite(GLuint tID, int idx, CharacterSheet layout) : textureID(tID), index(idx) {
+        float rows = layout == PLAYER_SHEET ? 5.5f : 3.0f;
         u = (float)(((int)idx) % 7) / (float) 7.0;
-        v = (float)(((int)idx) / 7) / (float) 5.5;
+        v = (float)(((int)idx) / 7) / rows;
         width = 1.0/(float)7.0;
-        height = 1.0/(float)5.5;
+        height = 1.0/rows;
         size = TILE_SIZE;
     };
     
-    SheetSprite(GLuint tID, int idx, int enemyMarker) : textureID(tID), index(idx) {
-        u = (float)(((int)idx) % 7) / (float) 7.0;
-        v = (float)(((int)idx) / 7) / (float) 3.0;
-        width = 1.0/(float)7.0;
-        height = 1.0/(float)3.0;
-        size = TILE_SIZE;
-    };
-    
-    void Draw(ShaderProgram *program);
-    
-    void DrawUniform(ShaderProgram *program);
+    void Submit(RenderQueue &queue, ShaderProgram *program, int layer, const Matrix &modelview) const;
     
     int index;
     float size;
@@ -158,141 +218,22 @@ public:
     float height;
 };
 
-void SheetSprite::Draw(ShaderProgram *program) {
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    GLfloat texCoords[] = {
-        u, v+height,
-        u+width, v,
-        u, v,
-        u+width, v,
-        u, v+height,
-        u+width, v+height
-    };
+void SheetSprite::Submit(RenderQueue &queue, ShaderProgram *program, int layer, const Matrix &modelview) const {
     float aspect = width / height;
-    float vertices[] = {
-        -0.5f * size * aspect, -0.5f * size,
-        0.5f * size * aspect, 0.5f * size,
-        -0.5f * size * aspect, 0.5f * size,
-        0.5f * size * aspect, 0.5f * size,
-        -0.5f * size * aspect, -0.5f * size ,
-        0.5f * size * aspect, -0.5f * size
-    };
-    
-    glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertices);
-    glEnableVertexAttribArray(program->positionAttribute);
-    
-    glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, texCoords);
-    glEnableVertexAttribArray(program->texCoordAttribute);
-    
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    
-    glDisableVertexAttribArray(program->positionAttribute);
-    glDisableVertexAttribArray(program->texCoordAttribute);
+    SpriteVertex corners[4];
+    SetQuad(corners, -0.5f * size * aspect, 0.5f * size, 0.5f * size * aspect, -0.5f * size, u, v, u+width, v+height);
+    queue.SubmitQuads(layer, program, textureID, modelview, corners, 1);
 }
 
-void SheetSprite::DrawUniform(ShaderProgram *program) {
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    GLfloat texCoords[] = {
-        u, v+height,
-        u+width, v,
-        u, v,
-        u+width, v,
-        u, v+height,
-        u+width, v+height
-    };
-    float aspect = width / height;
-    float vertices[] = {
-        -0.5f * size * aspect, -0.5f * size,
-        0.5f * size * aspect, 0.5f * size,
-        -0.5f * size * aspect, 0.5f * size,
-        0.5f * size * aspect, 0.5f * size,
-        -0.5f * size * aspect, -0.5f * size ,
-        0.5f * size * aspect, -0.5f * size
-    };
-    
-    glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertices);
-    glEnableVertexAttribArray(program->positionAttribute);
-    
-    glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, texCoords);
-    glEnableVertexAttribArray(program->texCoordAttribute);
-    
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    
-    glDisableVertexAttribArray(program->positionAttribute);
-    glDisableVertexAttribArray(program->texCoordAttribute);
-}
-
-void DrawText(ShaderProgram *program, int fontTexture, std::string text, float size, float spacing) {
-    glBindTexture(GL_TEXTURE_2D, fontTexture);
-    float texture_size = 1.0/16.0f;
-    std::vector<float> vertexData;
-    std::vector<float> texCoordData;
-    for(int i=0; i < text.size(); i++) {
-        int spriteIndex = (int)text[i];
-        float texture_x = (float)(spriteIndex % 16) / 16.0f;
-        float texture_y = (float)(spriteIndex / 16) / 16.0f;
-        vertexData.insert(vertexData.end(), {
-            ((size+spacing) * i) + (-0.5f * size), 0.5f * size,
-            ((size+spacing) * i) + (-0.5f * size), -0.5f * size,
-            ((size+spacing) * i) + (0.5f * size), 0.5f * size,
-            ((size+spacing) * i) + (0.5f * size), -0.5f * size,
-            ((size+spacing) * i) + (0.5f * size), 0.5f * size,
-            ((size+spacing) * i) + (-0.5f * size), -0.5f * size,
-        });
-        texCoordData.insert(texCoordData.end(), {
-            texture_x, texture_y,
-            texture_x, texture_y + texture_size,
-            texture_x + texture_size, texture_y,
-            texture_x + texture_size, texture_y + texture_size,
-            texture_x + texture_size, texture_y,
-            texture_x, texture_y + texture_size,
-        });
-    }
-    // draw this data (use the .data() method of std::vector to get pointer to data)
-    
-    glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertexData.data());
-    glEnableVertexAttribArray(program->positionAttribute);
-    
-    glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, texCoordData.data());
-    glEnableVertexAttribArray(program->texCoordAttribute);
-    
-    glDrawArrays(GL_TRIANGLES, 0, text.length()*6.0f);
-    
-    glDisableVertexAttribArray(program->positionAttribute);
-    glDisableVertexAttribArray(program->texCoordAttribute);
-    
+//text always goes on top of everything else
+void DrawText(ShaderProgram *program, int fontTexture, const Matrix &modelview, const char *text, float size, float spacing) {
+    renderQueue.SubmitText(LAYER_UI, program, fontTexture, modelview, text, size, spacing);
 }
 
 void drawBackground(ShaderProgram* program, GLuint texture)
 {
-    glBindTexture(GL_TEXTURE_2D, texture);
-    float vertices[] = {
-        -10.0f, 5.0f,  // Triangle 1 Coord A
-        -10.0f, -5.0f, // Triangle 1 Coord B
-        10.0f, -5.0f,   // Triangle 1 Coord C
-        -10.0f, 5.0f,   // Triangle 2 Coord A
-        10.0f, -5.0f, // Triangle 2 Coord B
-        10.0f, 5.0f   // Triangle 2 Coord C
-    };
-    
-    
-    float texCoords[] = {
-        0.0f, 0.0f,
-        0.0f, 1.0f,
-        1.0f, 1.0f,
-        0.0f, 0.0f,
-        1.0f, 1.0f,
-        1.0f, 0.0f
-    };
-    glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertices);
-    glEnableVertexAttribArray(program->positionAttribute);
-    
-    glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, texCoords);
-    glEnableVertexAttribArray(program->texCoordAttribute);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    
-    glDisableVertexAttribArray(program->positionAttribute);
-    glDisableVertexAttribArray(program->texCoordAttribute);
+    Matrix identity;
+    renderQueue.SubmitMesh(LAYER_BACKGROUND, program, texture, 0, identity, &backgroundMesh, TextureRegionAlpha(texture, 0.0f, 0.0f, 1.0f, 1.0f));
 }
 
 class Entity {
@@ -305,9 +246,11 @@ public:
         width = TILE_SIZE * 0.5;
         penetration.x = 0.0;
         penetration.y = 0.0;
-    }
-    void Draw(ShaderProgram* program) {
-        sprite.DrawUniform(program);
+        moonwalking = false;
+        collidedTop = false;
+        collidedBottom = false;
+        collidedLeft = false;
+        collidedRight = false;
     }
     
     //collision with tile handlers
@@ -316,7 +259,8 @@ public:
     bool isSolid(int index);
     
     void Update(float elapsed);
-    void Render(ShaderProgram &program);
+    //remembers where the entity is before a simulation step moves it
+    void KeepPrevious();
     
     //collision with other entities handler
     void CollidesWith(Entity* entity);
@@ -336,6 +280,9 @@ public:
     Matrix modelMatrix;
     Matrix modelviewMatrix;
     
+    Vector3 previousPosition;
+    Matrix previousModelMatrix;
+    
     bool isStatic;
     EntityType entityType;
     bool render;
@@ -347,6 +294,9 @@ public:
     bool collidedBottom;
     bool collidedLeft;
     bool collidedRight;
+    
+    //walking left on the ground, the snapshot passes it on since Update can't draw
+    bool moonwalking;
 };
 
 bool Entity::isSolid(int index){
@@ -365,7 +315,7 @@ void Entity::collideTileX(){
     //left collision
     worldToTileCoordinates(position.x - (width / 2.0f), position.y, &tileX, &tileY);
     
-    if(isSolid(levelData[tileY][tileX])) {
+    if(isSolid(levels.current->levelData[tileY][tileX])) {
         if(entityType == ENTITY_ENEMY){
             velocity.x = 1.0;
             acceleration.x = 2.5;
@@ -381,7 +331,7 @@ void Entity::collideTileX(){
     
     //right collision
     worldToTileCoordinates(position.x + (width / 2), position.y, &tileX, &tileY);
-    if(isSolid(levelData[tileY][tileX])) {
+    if(isSolid(levels.current->levelData[tileY][tileX])) {
         if(entityType == ENTITY_ENEMY){
             velocity.x = -1.0;
             acceleration.x = -2.5;
@@ -402,7 +352,7 @@ void Entity::collideTileY(){
     int tileY = 0;
     //top collision
     worldToTileCoordinates(position.x, position.y + (height / 2), &tileX, &tileY);
-    if(isSolid(levelData[tileY][tileX])){
+    if(isSolid(levels.current->levelData[tileY][tileX])){
         collidedTop = true;
         velocity.y = 0.0f;
         penetration.y = fabs((position.y + (height / 2)) - ((-TILE_SIZE * tileY) - TILE_SIZE));
@@ -415,7 +365,7 @@ void Entity::collideTileY(){
     
     //bottom collision
     worldToTileCoordinates(position.x, position.y - (height / 2), &tileX, &tileY);
-    if(isSolid(levelData[tileY][tileX])) {
+    if(isSolid(levels.current->levelData[tileY][tileX])) {
         collidedBottom = true;
         velocity.y = 0.0f;
         acceleration.y = 0.0f;
@@ -433,29 +383,30 @@ void Entity::Update(float elapsed) {
     velocity.x = lerp(velocity.x, 0.0f, elapsed*friction.x);
     velocity.y = lerp(velocity.y, 0.0f, elapsed*friction.y);
     if(entityType == ENTITY_PLAYER) {
-        const Uint8 *keys = SDL_GetKeyboardState(NULL);
-        if (keys[SDL_SCANCODE_LEFT] || keys[SDL_SCANCODE_A]) {
+        moonwalking = false;
+        int keys = heldKeys;
+        if (keys & HELD_LEFT) {
             if(mode == STATE_GAME_LEVEL1 || mode == STATE_GAME_LEVEL2 || mode == STATE_GAME_LEVEL3){
                 acceleration.x = -3.5f;
                 if(collidedBottom == true) {
-                    DrawText(&program, fontTexture, "  MOONWALK", 0.5f, 0.0f);
-                    sprite = SheetSprite(psheet, runAnimation[currentIndex], "player");
+                    moonwalking = true;
+                    sprite = SheetSprite(psheet, runAnimation[currentIndex], PLAYER_SHEET);
                 }
             }
         }
-        else if (keys[SDL_SCANCODE_RIGHT] || keys[SDL_SCANCODE_D]) {
+        else if (keys & HELD_RIGHT) {
             if(mode == STATE_GAME_LEVEL1 || mode == STATE_GAME_LEVEL2 || mode == STATE_GAME_LEVEL3){
                 acceleration.x = 3.5f;
                 if(collidedBottom == true) {
-                    sprite = SheetSprite(psheet, runAnimation[currentIndex], "player");
+                    sprite = SheetSprite(psheet, runAnimation[currentIndex], PLAYER_SHEET);
                 }
             }
         }
-        if (keys[SDL_SCANCODE_UP] || keys[SDL_SCANCODE_W]) {
+        if (keys & HELD_UP) {
             if(mode == STATE_GAME_LEVEL1 || mode == STATE_GAME_LEVEL2 || mode == STATE_GAME_LEVEL3){
                 if (collidedBottom == true) {
-                    sprite = SheetSprite(psheet, 13, "player");
-                    Mix_PlayChannel(-1, jump, 0);
+                    sprite = SheetSprite(psheet, 13, PLAYER_SHEET);
+                    audio.Post(GAME_EVENT_JUMP);
                     velocity.y = 4.8f;
                 }
             }
@@ -467,8 +418,12 @@ void Entity::Update(float elapsed) {
     velocity.y += acceleration.y * elapsed;
     
     //update position and check for collisions with tiles
+    bool wasOnGround = collidedBottom;
     position.y += velocity.y * elapsed;
     collideTileY();
+    if(entityType == ENTITY_PLAYER && collidedBottom && !wasOnGround) {
+        audio.Post(GAME_EVENT_LAND);
+    }
     
     position.x += velocity.x * elapsed;
     collideTileX();
@@ -479,13 +434,12 @@ void Entity::Update(float elapsed) {
     }
 }
 
-void Entity::Render(ShaderProgram &program){
-    modelviewMatrix = viewMatrix * modelMatrix;
-    if(render) {
-        this->Draw(&program);
-    }
+void Entity::KeepPrevious() {
+    previousPosition = position;
+    previousModelMatrix = modelMatrix;
 }
 
+
 bool Entity::collision(Entity* entity) {
     bool collide = false;
     if((position.x + (width / 2) >= entity->position.x - (entity->width / 2)) && (position.x + (width / 2) <= entity->position.x + (entity->width / 2))
@@ -509,29 +463,20 @@ void Entity::CollidesWith(Entity* entity) {
     }
     
     if(collide && entity->entityType == ENTITY_GOAL){
-        //PLAYER GOES TO NEXT LEVEL
-        if(mode == STATE_GAME_LEVEL1) {
-            createMap(RESOURCE_FOLDER"level2.txt");
-            mode = STATE_GAME_LEVEL2;
-            Mix_PlayMusic(music2, -1);
-            timer = 0.0;
-        }
-        else if(mode == STATE_GAME_LEVEL2){
-            createMap(RESOURCE_FOLDER"level3.txt");
-            mode = STATE_GAME_LEVEL3;
-            Mix_PlayMusic(music3, -1);
-            timer = 0.0;
+        //PLAYER GOES TO NEXT LEVEL, the swap happens at the end of the tick
+        if(levels.HasNext()) {
+            levels.RequestNext();
         }
-        else if(mode == STATE_GAME_LEVEL3) {
+        else {
             mode = STATE_GAME_WIN;
-            Mix_PlayMusic(win, -1);
+            audio.Post(GAME_EVENT_WIN);
             timer = 0.0;
         }
     }
     else if(collide && (entity->entityType == ENTITY_ENEMY)){
         //PLAYER DIES GAMEOVER
         mode = STATE_GAME_OVER;
-        Mix_PlayMusic(lose, -1);
+        audio.Post(GAME_EVENT_LOSE);
         timer = 0.0;
     }
     
@@ -541,36 +486,6 @@ Entity player;
 Entity enemy;
 Entity goal;
 
-bool readLayerData(ifstream& stream) {
-    string line;
-    while(getline(stream, line)) {
-        if(line == "") {
-            break;
-        }
-        istringstream sStream(line);
-        string key,value;
-        getline(sStream, key, '=');
-        getline(sStream, value);
-        
-        if(key == "data") {
-            for(int y = 0; y < mapHeight; y++) {
-                getline(stream, line);
-                istringstream lineStream(line);
-                string tile;
-                for(int x = 0; x < mapWidth; x++) {
-                    getline(lineStream, tile, ',');
-                    int val =  atoi(tile.c_str());
-                    if(val > 0) {
-                        // be careful, the tiles in this format are indexed from 1 not 0
-                        levelData[y][x] = val-1;
-                    } else {
-                        levelData[y][x] = 0;
-                    }
-                }
-            } }
-    }
-    return true;
-}
 void placeEntity(string type, float x, float y)
 {
     if (type == "player") {
@@ -580,7 +495,7 @@ void placeEntity(string type, float x, float y)
         player.velocity = Vector3(0.0f, 0.0f, 0.0f);
         player.acceleration = Vector3(0.0f, -1.0f, 0.0f);
         player.render = true;
-        player.sprite = SheetSprite(psheet, 1, "player");
+        player.sprite = SheetSprite(psheet, 1, PLAYER_SHEET);
         player.size.x = player.sprite.width;
         player.size.y = player.sprite.height;
         player.modelMatrix.Identity();
@@ -598,7 +513,7 @@ void placeEntity(string type, float x, float y)
         enemy.velocity = Vector3(2.0f, 0.0f, 0.0f);
         enemy.acceleration = Vector3(1.0f, -1.0f, 0.0f);
         enemy.render = true;
-        enemy.sprite = SheetSprite(esheet, 1, 1);
+        enemy.sprite = SheetSprite(esheet, 1, ENEMY_SHEET);
         enemy.size.x = enemy.sprite.width;
         enemy.size.y = enemy.sprite.height;
         enemy.modelMatrix.Identity();
@@ -629,98 +544,33 @@ void placeEntity(string type, float x, float y)
     }
 }
 
-bool readEntityData(ifstream &stream) {
-    string line;
-    string type;
-    while(getline(stream, line)) {
-        if(line == "") {
-            break;
-        }
-        
-        istringstream sStream(line);
-        string key,value;
-        getline(sStream, key, '=');
-        getline(sStream, value);
-        if(key == "type") {
-            type = value;
-        }
-        else if(key == "location") {
-            istringstream lineStream(value);
-            string xPosition, yPosition;
-            getline(lineStream, xPosition, ',');
-            getline(lineStream, yPosition, ',');
-            float placeX = atoi(xPosition.c_str())*TILE_SIZE;
-            float placeY = atoi(yPosition.c_str())*-TILE_SIZE;
-            placeEntity(type, placeX, placeY);
-        }
-    }
-    return true;
+//called before every simulation step, and after anything that moves entities in one jump so they don't slide there
+void keepPreviousState() {
+    player.KeepPrevious();
+    enemy.KeepPrevious();
+    goal.KeepPrevious();
+    previousViewMatrix = viewMatrix;
 }
 
-void createMap(string input)
-{
-    ifstream gamedata(input);
-    string line;
-    while (getline(gamedata, line)) {
-        if (line == "[layer]") {
-            readLayerData(gamedata);
-        }
-        else if (line == "[ObjectsLayer]") {
-            readEntityData(gamedata);
-        }
+void enterLevel(Level* level) {
+    for(size_t i = 0; i < level->entities.size(); i++) {
+        placeEntity(level->entities[i].type, level->entities[i].x, level->entities[i].y);
     }
-}
-
-void drawMap(ShaderProgram* program) {
-    glBindTexture(GL_TEXTURE_2D, sheet);
-    vector<float> vertexData;
-    vector<float> texCoordData;
-    for(int y=0; y < mapHeight; y++) {
-        for(int x=0; x < mapWidth; x++) {
-            if(levelData[y][x] != 0) {
-                float u = (float)(((int)levelData[y][x]) % SPRITE_COUNT_X) / (float) SPRITE_COUNT_X;
-                float v = (float)(((int)levelData[y][x]) / SPRITE_COUNT_X) / (float) SPRITE_COUNT_Y;
-                float spriteWidth = 1.0f/(float)SPRITE_COUNT_X;
-                float spriteHeight = 1.0f/(float)SPRITE_COUNT_Y;
-                vertexData.insert(vertexData.end(), {
-                    TILE_SIZE * x, -TILE_SIZE * y,
-                    TILE_SIZE * x, (-TILE_SIZE * y)-TILE_SIZE,
-                    (TILE_SIZE * x)+TILE_SIZE, (-TILE_SIZE * y)-TILE_SIZE,
-                    TILE_SIZE * x, -TILE_SIZE * y,
-                    (TILE_SIZE * x)+TILE_SIZE, (-TILE_SIZE * y)-TILE_SIZE,
-                    (TILE_SIZE * x)+TILE_SIZE, -TILE_SIZE * y
-                });
-                texCoordData.insert(texCoordData.end(), {
-                    u, v,
-                    u, v+(spriteHeight),
-                    u+spriteWidth, v+(spriteHeight),
-                    u, v,
-                    u+spriteWidth, v+(spriteHeight),
-                    u+spriteWidth, v
-                });
-            }
-        }
-    }
-    
-    glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertexData.data());
-    glEnableVertexAttribArray(program->positionAttribute);
-    
-    glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, texCoordData.data());
-    glEnableVertexAttribArray(program->texCoordAttribute);
-    
-    glDrawArrays(GL_TRIANGLES, 0, (int)vertexData.size() / 2);
-    
-    glDisableVertexAttribArray(program->positionAttribute);
-    glDisableVertexAttribArray(program->texCoordAttribute);
+    mode = (GameMode)(STATE_GAME_LEVEL1 + levels.currentIndex);
+    timer = 0.0;
+    keepPreviousState();
+    audio.Post(GAME_EVENT_LEVEL_START, level->music);
 }
 
 void Update(float elapsed) {
-    if(mode != STATE_PAUSE){
+    if(mode == STATE_GAME_LEVEL1 || mode == STATE_GAME_LEVEL2 || mode == STATE_GAME_LEVEL3){
+        //how long the level title has been up
+        timer += elapsed;
         player.Update(elapsed);
         player.CollidesWith(&enemy);
         player.CollidesWith(&enemy);
         if(abs(enemy.position.x - player.position.x) < 6.0 && abs(enemy.position.y - player.position.y) < 4.0){
-            enemy.sprite = SheetSprite(angry, moveAnimation[enemyIndex], 0);
+            enemy.sprite = SheetSprite(angry, moveAnimation[enemyIndex], ENEMY_SHEET);
             if(enemy.acceleration.x > 0.0){
                 enemy.acceleration.x = 5.0;
             }
@@ -729,7 +579,7 @@ void Update(float elapsed) {
             }
         }
         else{
-            enemy.sprite = SheetSprite(esheet, moveAnimation[enemyIndex], 0);
+            enemy.sprite = SheetSprite(esheet, moveAnimation[enemyIndex], ENEMY_SHEET);
             if(enemy.acceleration.x > 0.0){
                 enemy.velocity.x = 1.5;
                 enemy.acceleration.x = 2.5;
@@ -739,9 +589,10 @@ void Update(float elapsed) {
                 enemy.acceleration.x = -2.5;
             }
         }
-        //enemy.sprite = SheetSprite(esheet, moveAnimation[enemyIndex], 0);
-        enemy.Update(elapsed);
+        //enemy.sprite = SheetSprite(esheet, moveAnimation[enemyIndex], ENEMY_SHEET);
         player.CollidesWith(&goal);
+        //two entities are far too little work to be worth handing to the job system
+        enemy.Update(elapsed);
         goal.Update(elapsed);
         viewMatrix.Identity();
         if(player.position.x <= 9.8) {
@@ -753,56 +604,190 @@ void Update(float elapsed) {
         else{
             viewMatrix.Translate(-player.position.x, -player.position.y - 2.0, 0.0f);
         }
+        if(levels.TransitionPending() && mode != STATE_GAME_OVER) {
+            enterLevel(levels.Advance());
+        }
+    }
+    else if(mode == STATE_MAIN_MENU) {
+        //the player runs across the menu
+        player.position.x += 0.01;
+        if(player.position.x >= 9.90){
+            player.position.x = -9.90;
+            player.previousPosition.x = player.position.x;
+        }
+        player.sprite = SheetSprite(psheet, runAnimation[currentIndex], PLAYER_SHEET);
+        timer = 0.0;
     }
     
 }
 
-void Render1() {
-    mapModelMatrix.Identity();
-    mapMVM = viewMatrix * mapModelMatrix;
-    program.SetModelviewMatrix(mapMVM);
-    drawMap(&program);
-    enemy.modelviewMatrix = viewMatrix * enemy.modelMatrix;
-    program.SetModelviewMatrix(enemy.modelviewMatrix);
-    enemy.Render(program);
-    goal.modelviewMatrix = viewMatrix * goal.modelMatrix;
-    program.SetModelviewMatrix(goal.modelviewMatrix);
-    goal.Render(program);
-    player.modelviewMatrix = viewMatrix * player.modelMatrix;
-    program.SetModelviewMatrix(player.modelviewMatrix);
-    player.Render(program);
+//t is how far the frame is between the last two simulation steps
+//what the renderer needs of an entity at the end of a simulation step
+class EntitySnapshot {
+public:
+    EntitySnapshot() : render(false) {}
+    
+    void Take(const Entity &entity);
+    //t of the way from the previous step to this one
+    Matrix InterpolatedModel(float t) const;
+    void Render(RenderQueue &queue, ShaderProgram &program, int layer, const Matrix &modelview) const;
+    
+    SheetSprite sprite;
+    Matrix previousModel;
+    Matrix model;
+    bool render;
+};
+
+void EntitySnapshot::Take(const Entity &entity) {
+    sprite = entity.sprite;
+    previousModel = entity.previousModelMatrix;
+    model = entity.modelMatrix;
+    render = entity.render;
 }
 
-void Render2() {
-    mapModelMatrix.Identity();
-    mapMVM = viewMatrix * mapModelMatrix;
-    program.SetModelviewMatrix(mapMVM);
-    drawMap(&program);
-    enemy.modelviewMatrix = viewMatrix * enemy.modelMatrix;
-    program.SetModelviewMatrix(enemy.modelviewMatrix);
-    enemy.Render(program);
-    goal.modelviewMatrix = viewMatrix * goal.modelMatrix;
-    program.SetModelviewMatrix(goal.modelviewMatrix);
-    goal.Render(program);
-    player.modelviewMatrix = viewMatrix * player.modelMatrix;
-    program.SetModelviewMatrix(player.modelviewMatrix);
-    player.Render(program);
+Matrix EntitySnapshot::InterpolatedModel(float t) const {
+    return interpolateTranslation(previousModel, model, t);
 }
 
-void Render3() {
-    mapModelMatrix.Identity();
-    mapMVM = viewMatrix * mapModelMatrix;
-    program.SetModelviewMatrix(mapMVM);
-    drawMap(&program);
-    enemy.modelviewMatrix = viewMatrix * enemy.modelMatrix;
-    program.SetModelviewMatrix(enemy.modelviewMatrix);
-    enemy.Render(program);
-    goal.modelviewMatrix = viewMatrix * goal.modelMatrix;
-    program.SetModelviewMatrix(goal.modelviewMatrix);
-    goal.Render(program);
-    player.modelviewMatrix = viewMatrix * player.modelMatrix;
-    program.SetModelviewMatrix(player.modelviewMatrix);
-    player.Render(program);
+void EntitySnapshot::Render(RenderQueue &queue, ShaderProgram &program, int layer, const Matrix &modelview) const {
+    if(render) {
+        sprite.Submit(queue, &program, layer, modelview);
+    }
+}
+
+//everything a frame draws, copied out of the game after every simulation step
+//the render thread only ever reads these, never the globals the simulation thread is changing
+class FrameSnapshot {
+public:
+    FrameSnapshot() : mode(STATE_MAIN_MENU), timer(0.0f), moonwalking(false), previousRunnerX(0.0f), runnerX(0.0f), level(NULL), stepEnd(0) {}
+    
+    GameMode mode;
+    float timer;
+    
+    Matrix previousView;
+    Matrix view;
+    EntitySnapshot player;
+    EntitySnapshot enemy;
+    EntitySnapshot goal;
+    bool moonwalking;
+    
+    //the main menu runner only moves along x
+    float previousRunnerX;
+    float runnerX;
+    
+    //the render thread uploads and draws it, LevelManager keeps it alive while a snapshot can point at it
+    Level *level;
+    //performance counter when the step finished, frames are drawn up to one step after it
+    Uint64 stepEnd;
+};
+
+void takeSnapshot(FrameSnapshot &frame, Uint64 stepEnd) {
+    frame.mode = mode;
+    frame.timer = timer;
+    frame.previousView = previousViewMatrix;
+    frame.view = viewMatrix;
+    frame.player.Take(player);
+    frame.enemy.Take(enemy);
+    frame.goal.Take(goal);
+    frame.moonwalking = player.moonwalking;
+    frame.previousRunnerX = player.previousPosition.x;
+    frame.runnerX = player.position.x;
+    frame.level = levels.current;
+    frame.stepEnd = stepEnd;
+}
+
+//the simulation runs on its own thread and hands the render thread a snapshot after every step
+TripleBuffer<FrameSnapshot> snapshots;
+std::thread simulationThread;
+std::atomic<bool> simulationRunning(false);
+//held through every step, so the render thread can pause the simulation to swap in a hot reloaded level
+std::mutex simulationLock;
+//key presses from the main thread, only it can pump SDL events
+std::mutex inputLock;
+std::vector<SDL_Event> pendingInput;
+//Escape on the main menu, the main thread ends the loop when it sees it
+std::atomic<bool> quitRequested(false);
+
+//t is how far the frame is between the last two simulation steps
+void RenderLevel(const FrameSnapshot &frame, float t) {
+    Matrix view = interpolateTranslation(frame.previousView, frame.view, t);
+    submitLevel(frame.level, view, false);
+    frame.enemy.Render(renderQueue, program, LAYER_ENTITIES, view * frame.enemy.InterpolatedModel(t));
+    frame.goal.Render(renderQueue, program, LAYER_ENTITIES, view * frame.goal.InterpolatedModel(t));
+    Matrix playerModelview = view * frame.player.InterpolatedModel(t);
+    frame.player.Render(renderQueue, program, LAYER_PLAYER, playerModelview);
+    if(frame.moonwalking) {
+        DrawText(&program, fontTexture, playerModelview, "  MOONWALK", 0.5f, 0.0f);
+    }
+    submitLevel(frame.level, view, true);
+}
+
+//every frame starts from the clear color of the level being shown
+void clearFrame(GameMode shown) {
+    if(shown == STATE_GAME_LEVEL1) {
+        glClearColor(0.0f, 0.5f, 1.0f, 1.0f);
+    }
+    else if(shown == STATE_GAME_LEVEL3){
+        glClearColor(0.3f, 0.0f, 1.0f, 1.0f);
+    }
+    else{
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+//Update and RenderSelect never touch GL, whatever they need uploaded or freed happens here before the queue is drawn
+void drawSubmitted(GpuProfiler *profiler, Level *level) {
+    levels.ReleaseRetired(level);
+    if(level != NULL) {
+        level->PrepareDraw(tileMapProgram, sheet);
+    }
+    if(backgroundMesh.vertexBuffer == 0) {
+        SpriteVertex corners[4];
+        SetQuad(corners, -10.0f, 5.0f, 10.0f, -5.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+        backgroundMesh.Upload(corners, 1, VERTEX_SPRITE, GL_STATIC_DRAW);
+    }
+    
+    streamBuffer.BeginFrame();
+    renderQueue.Flush(streamBuffer, profiler);
+    streamBuffer.EndFrame();
+}
+
+void drawProfilerLine(int row, const char *text) {
+    Matrix position;
+    position.Translate(-9.2f, 3.7f - row * 0.35f, 0.0f);
+    DrawText(&program, fontTexture, position, text, 0.3f, -0.1f);
+}
+
+//GPU times are from the newest frame the GPU has finished, a few frames behind, the counts are from the last frame
+void drawProfilerOverlay() {
+    const RenderStats &stats = LastRenderStats();
+    //the lines are built in the frame arena, turning the overlay on doesn't add heap allocations
+    FrameStringStream counts;
+    counts << stats.drawCalls << " DRAWS " << stats.triangles << " TRIS " << stats.vertexBytes / 1024 << "KB";
+    drawProfilerLine(0, counts.str().c_str());
+    FrameStringStream state;
+    state << stats.textureBinds << " TEX " << stats.programSwitches << " PROG " << stats.uniformUploads << " UNIF";
+    drawProfilerLine(1, state.str().c_str());
+    //a growth means some frame needed the heap, the next ones fit again
+    FrameStringStream arena;
+    arena << RenderArena().Capacity() / 1024 << "KB ARENA " << RenderArena().Growths() << " GROWN";
+    drawProfilerLine(2, arena.str().c_str());
+
+    if(!gpuProfiler.Enabled()) {
+        drawProfilerLine(3, "NO GPU TIMERS");
+        return;
+    }
+    for(int i = 0; i <= GPU_PASS_COUNT; i++) {
+        FrameStringStream line;
+        line << std::fixed << std::setprecision(2);
+        if(i < GPU_PASS_COUNT) {
+            line << GpuProfiler::PassName((GpuPass)i) << " " << gpuProfiler.passTimes[i] << "MS";
+        } else {
+            line << "GPU " << gpuProfiler.frameTime << "MS";
+        }
+        drawProfilerLine(i + 3, line.str().c_str());
+    }
 }
 
 Matrix modelviewMatrix;
@@ -810,40 +795,25 @@ Matrix modelviewMatrix2;
 Matrix modelviewMatrix3;
 Matrix modelviewMatrix4;
 Matrix modelviewMatrix5;
-Matrix bgMVM;
 
-void RenderSelect(float elapsed){
-    switch(mode){
+void RenderSelect(const FrameSnapshot &frame, float t){
+    switch(frame.mode){
         case STATE_MAIN_MENU:
-            bgMVM.Identity();
-            program.SetModelviewMatrix(bgMVM);
             drawBackground(&program, bg);
-            player.position.x += 0.01;
-            if(player.position.x >= 9.90){
-                player.position.x = -9.90;
-            }
-            player.modelviewMatrix.Identity();
-            player.modelviewMatrix.Translate(player.position.x, -3.0, 0.0f);
-            player.sprite = SheetSprite(psheet, runAnimation[currentIndex], "player");
-            program.SetModelviewMatrix(player.modelviewMatrix);
-            player.Render(program);
+            modelviewMatrix.Identity();
+            modelviewMatrix.Translate(lerp(frame.previousRunnerX, frame.runnerX, t), -3.0, 0.0f);
+            frame.player.Render(renderQueue, program, LAYER_PLAYER, modelviewMatrix);
             modelviewMatrix.Identity();
             modelviewMatrix2.Identity();
             modelviewMatrix3.Identity();
             modelviewMatrix.Translate(-4.0, 1.5, 0.0);
             modelviewMatrix2.Translate(-4.6, -1.2, 0.0);
             modelviewMatrix3.Translate(-4.45, -2.2, 0.0);
-            program.SetModelviewMatrix(modelviewMatrix);
-            DrawText(&program, fontTexture, "Space Boy", 1.0f, 0.0f);
-            program.SetModelviewMatrix(modelviewMatrix2);
-            DrawText(&program, fontTexture, "Press Space to Begin", 0.5f, 0.0f);
-            program.SetModelviewMatrix(modelviewMatrix3);
-            DrawText(&program, fontTexture, "Press I to See Instructions", 0.35f, 0.0f);
-            timer = 0.0;
+            DrawText(&program, fontTexture, modelviewMatrix, "Space Boy", 1.0f, 0.0f);
+            DrawText(&program, fontTexture, modelviewMatrix2, "Press Space to Begin", 0.5f, 0.0f);
+            DrawText(&program, fontTexture, modelviewMatrix3, "Press I to See Instructions", 0.35f, 0.0f);
             break;
         case STATE_MANUAL:
-            bgMVM.Identity();
-            program.SetModelviewMatrix(bgMVM);
             drawBackground(&program, bg);
             modelviewMatrix.Identity();
             modelviewMatrix2.Identity();
@@ -855,20 +825,13 @@ void RenderSelect(float elapsed){
             modelviewMatrix3.Translate(0.0, 1.5, 0.0);
             modelviewMatrix4.Translate(-9.0, 0.0, 0.0);
             modelviewMatrix5.Translate(-5.5, -3.0, 0.0);
-            program.SetModelviewMatrix(modelviewMatrix);
-            DrawText(&program, fontTexture, "INSTRUCTIONS", 1.0f, 0.0f);
-            program.SetModelviewMatrix(modelviewMatrix2);
-            DrawText(&program, fontTexture, "A or Left - Move Left", 0.35f, 0.0f);
-            program.SetModelviewMatrix(modelviewMatrix3);
-            DrawText(&program, fontTexture, "D or Right - Move Right", 0.35f, 0.0f);
-            program.SetModelviewMatrix(modelviewMatrix4);
-            DrawText(&program, fontTexture, "W or Up - Jump", 0.35f, 0.0f);
-            program.SetModelviewMatrix(modelviewMatrix5);
-            DrawText(&program, fontTexture, "Press Space to Return to Main Menu", 0.35f, 0.0f);
+            DrawText(&program, fontTexture, modelviewMatrix, "INSTRUCTIONS", 1.0f, 0.0f);
+            DrawText(&program, fontTexture, modelviewMatrix2, "A or Left - Move Left", 0.35f, 0.0f);
+            DrawText(&program, fontTexture, modelviewMatrix3, "D or Right - Move Right", 0.35f, 0.0f);
+            DrawText(&program, fontTexture, modelviewMatrix4, "W or Up - Jump", 0.35f, 0.0f);
+            DrawText(&program, fontTexture, modelviewMatrix5, "Press Space to Return to Main Menu", 0.35f, 0.0f);
             break;
         case STATE_PAUSE:
-            bgMVM.Identity();
-            program.SetModelviewMatrix(bgMVM);
             drawBackground(&program, bg);
             modelviewMatrix.Identity();
             modelviewMatrix2.Identity();
@@ -876,285 +839,711 @@ void RenderSelect(float elapsed){
             modelviewMatrix.Translate(-5.15, 0.2, 0.0);
             modelviewMatrix2.Translate(-5.35, -1.2, 0.0);
             modelviewMatrix3.Translate(-4.0, 2.5, 0.0);
-            program.SetModelviewMatrix(modelviewMatrix);
-            DrawText(&program, fontTexture, "Press Space to Resume", 0.5f, 0.0f);
-            program.SetModelviewMatrix(modelviewMatrix2);
-            DrawText(&program, fontTexture, "Press Esc to Main Menu", 0.5f, 0.0f);
-            program.SetModelviewMatrix(modelviewMatrix3);
-            DrawText(&program, fontTexture, "PAUSED", 1.5f, 0.0f);
+            DrawText(&program, fontTexture, modelviewMatrix, "Press Space to Resume", 0.5f, 0.0f);
+            DrawText(&program, fontTexture, modelviewMatrix2, "Press Esc to Main Menu", 0.5f, 0.0f);
+            DrawText(&program, fontTexture, modelviewMatrix3, "PAUSED", 1.5f, 0.0f);
             break;
         case STATE_GAME_LEVEL1:
-            timer += elapsed;
-            if(timer < 0.37){
+            if(frame.timer < 0.37){
                 modelviewMatrix.Identity();
                 modelviewMatrix.Translate(-4.0, 1.5, 0.0);
-                program.SetModelviewMatrix(modelviewMatrix);
-                DrawText(&program, fontTexture, "LEVEL 1", 1.0f, 0.0f);
+                DrawText(&program, fontTexture, modelviewMatrix, "LEVEL 1", 1.0f, 0.0f);
             }
-            Render1();
+            RenderLevel(frame, t);
             break;
         case STATE_GAME_LEVEL2:
-            timer += elapsed;
-            if(timer < 0.37){
+            if(frame.timer < 0.37){
                 modelviewMatrix.Identity();
                 modelviewMatrix.Translate(-4.0, 0.0, 0.0);
-                program.SetModelviewMatrix(modelviewMatrix);
-                DrawText(&program, fontTexture, "LEVEL 2", 1.0f, 0.0f);
+                DrawText(&program, fontTexture, modelviewMatrix, "LEVEL 2", 1.0f, 0.0f);
             }
-            Render2();
+            RenderLevel(frame, t);
             break;
         case STATE_GAME_LEVEL3:
-            timer += elapsed;
-            if(timer < 0.37){
+            if(frame.timer < 0.37){
                 modelviewMatrix.Identity();
                 modelviewMatrix.Translate(-4.0, 1.5, 0.0);
-                program.SetModelviewMatrix(modelviewMatrix);
-                DrawText(&program, fontTexture, "LEVEL 3", 1.0f, 0.0f);
+                DrawText(&program, fontTexture, modelviewMatrix, "LEVEL 3", 1.0f, 0.0f);
             }
-            Render3();
+            RenderLevel(frame, t);
             break;
         case STATE_GAME_OVER:
-            bgMVM.Identity();
-            program.SetModelviewMatrix(bgMVM);
             drawBackground(&program, bg);
             modelviewMatrix.Identity();
             modelviewMatrix2.Identity();
             modelviewMatrix.Translate(-4.0, 1.5, 0.0);
             modelviewMatrix2.Translate(-4.7, -1.2, 0.0);
-            program.SetModelviewMatrix(modelviewMatrix);
-            DrawText(&program, fontTexture, "YOU LOST!", 1.0f, 0.0f);
-            program.SetModelviewMatrix(modelviewMatrix2);
-            DrawText(&program, fontTexture, "Press Space to Restart", 0.5f, 0.0f);
+            DrawText(&program, fontTexture, modelviewMatrix, "YOU LOST!", 1.0f, 0.0f);
+            DrawText(&program, fontTexture, modelviewMatrix2, "Press Space to Restart", 0.5f, 0.0f);
             break;
         case STATE_GAME_WIN:
-            bgMVM.Identity();
-            program.SetModelviewMatrix(bgMVM);
             drawBackground(&program, bg);
             modelviewMatrix.Identity();
             modelviewMatrix2.Identity();
             modelviewMatrix.Translate(-4.0, 1.5, 0.0);
             modelviewMatrix2.Translate(-6.9, -1.2, 0.0);
-            program.SetModelviewMatrix(modelviewMatrix);
-            DrawText(&program, fontTexture, "YOU WON!", 1.0f, 0.0f);
-            program.SetModelviewMatrix(modelviewMatrix2);
-            DrawText(&program, fontTexture, "Press Space to Go To Main Menu", 0.5f, 0.0f);
+            DrawText(&program, fontTexture, modelviewMatrix, "YOU WON!", 1.0f, 0.0f);
+            DrawText(&program, fontTexture, modelviewMatrix2, "Press Space to Go To Main Menu", 0.5f, 0.0f);
             break;
     }
 }
 
 
+//the menu keys, run on the simulation thread before its next step
+void handleKey(const SDL_Event &event) {
+    if (event.type == SDL_KEYDOWN){
+        if (event.key.keysym.scancode == SDL_SCANCODE_ESCAPE){
+            if(mode != STATE_PAUSE && (mode == STATE_GAME_LEVEL1 || mode == STATE_GAME_LEVEL2 || mode == STATE_GAME_LEVEL3)) {
+                audio.Post(GAME_EVENT_SELECT);
+                audio.Post(GAME_EVENT_PAUSE);
+                pausedMode = mode;
+                mode = STATE_PAUSE;
+            }
+            else if(mode != STATE_MAIN_MENU && mode == STATE_PAUSE){
+                audio.Post(GAME_EVENT_SELECT);
+                mode = STATE_MAIN_MENU;
+                audio.Post(GAME_EVENT_MAIN_MENU);
+                levels.Preload(0);
+            }
+            else{
+                quitRequested = true;
+            }
+        }
+        else if(event.key.keysym.scancode == SDL_SCANCODE_SPACE){
+            if(mode == STATE_MAIN_MENU) {
+                audio.Post(GAME_EVENT_SELECT);
+                enterLevel(levels.Start(0));
+            }
+            else if(mode == STATE_GAME_OVER || mode == STATE_GAME_WIN ||  mode == STATE_MANUAL) {
+                mode = STATE_MAIN_MENU;
+                audio.Post(GAME_EVENT_SELECT);
+                audio.Post(GAME_EVENT_MAIN_MENU);
+                levels.Preload(0);
+            }
+            else if(mode == STATE_PAUSE){
+                audio.Post(GAME_EVENT_RESUME);
+                mode = pausedMode;
+            }
+        }
+        else if(event.key.keysym.scancode == SDL_SCANCODE_I){
+            if(mode == STATE_MAIN_MENU){
+                mode = STATE_MANUAL;
+                audio.Post(GAME_EVENT_SELECT);
+            }
+        }
+        else if(event.key.keysym.scancode == SDL_SCANCODE_0){
+            if((mode == STATE_GAME_LEVEL1 || mode == STATE_GAME_LEVEL2) && levels.HasNext()){
+                enterLevel(levels.Advance());
+            }
+            else if(mode == STATE_GAME_LEVEL3){
+                mode = STATE_GAME_WIN;
+                audio.Post(GAME_EVENT_WIN);
+                timer = 0.0;
+            }
+        }
+    }
+    else if(event.type == SDL_KEYUP){
+        if(event.key.keysym.scancode == SDL_SCANCODE_LEFT || event.key.keysym.scancode == SDL_SCANCODE_A){
+            if(mode == STATE_GAME_LEVEL1 || mode == STATE_GAME_LEVEL2 || mode == STATE_GAME_LEVEL3){
+                player.acceleration.x = 0.0f;
+                player.velocity.x = 0.0f;
+            }
+        }
+        else if(event.key.keysym.scancode == SDL_SCANCODE_RIGHT || event.key.keysym.scancode == SDL_SCANCODE_D){
+            if(mode == STATE_GAME_LEVEL1 || mode == STATE_GAME_LEVEL2 || mode == STATE_GAME_LEVEL3){
+                player.acceleration.x = 0.0f;
+                player.velocity.x = 0.0f;
+            }
+        }
+    }
+}
+
+//steps the game at a fixed rate on its own thread and publishes a snapshot whenever anything changed
+//a slow frame on the render thread doesn't hold the simulation up, or the other way around
+void runSimulation() {
+    Uint64 lastCounter = SDL_GetPerformanceCounter();
+    float accumulator = 0.0f;
+    std::vector<SDL_Event> input;
+    while(simulationRunning) {
+        {
+            std::lock_guard<std::mutex> guard(inputLock);
+            input.swap(pendingInput);
+        }
+        Uint64 counter = SDL_GetPerformanceCounter();
+        accumulator += (float)((double)(counter - lastCounter) / (double)SDL_GetPerformanceFrequency());
+        lastCounter = counter;
+        
+        if(input.empty() && accumulator < simulationStep) {
+            SDL_Delay(1);
+            continue;
+        }
+        
+        double updateStart = trace.Now();
+        {
+            std::lock_guard<std::mutex> step(simulationLock);
+            for(size_t i = 0; i < input.size(); i++) {
+                handleKey(input[i]);
+            }
+            input.clear();
+            while(accumulator >= simulationStep) {
+                keepPreviousState();
+                Update(simulationStep);
+                accumulator -= simulationStep;
+                animationElapsed += accumulator;
+                if(animationElapsed > 1.0/framesPerSecond){
+                    currentIndex++;
+                    enemyIndex++;
+                    animationElapsed = 0.0;
+                    
+                    if(currentIndex > numFrames - 1) {
+                        currentIndex = 0;
+                    }
+                    if(enemyIndex > eFrames - 1) {
+                        enemyIndex = 0;
+                    }
+                }
+            }
+            //the last step ended accumulator seconds ago
+            Uint64 stepEnd = counter - (Uint64)(accumulator * (double)SDL_GetPerformanceFrequency());
+            takeSnapshot(snapshots.Back(), stepEnd);
+            snapshots.Publish();
+        }
+        trace.Complete("update", TRACE_THREAD_SIMULATION, updateStart, trace.Now() - updateStart);
+    }
+}
+
+//--count-allocs skips this many frames for level 1 to start and the caches to fill, then counts this many
+#define ALLOCATION_WARMUP_FRAMES 120
+#define ALLOCATION_COUNTED_FRAMES 600
+
+//--golden folder renders these and compares them with folder/name.png, --golden-update writes the references instead
+//the committed references are in Final Project/golden, rendered headless on the offscreen driver as its README.txt describes
+//level scenes leave the entities where the level spawns them and put the camera at cameraX, as high as the player starts
+class GoldenScene {
+    public:
+        const char *name;
+        GameMode mode;
+        int level;
+        float cameraX;
+        bool showTitle;
+};
+
+const GoldenScene goldenScenes[] = {
+    {"main_menu", STATE_MAIN_MENU, -1, 0.0f, false},
+    {"manual", STATE_MANUAL, -1, 0.0f, false},
+    {"pause", STATE_PAUSE, -1, 0.0f, false},
+    {"game_over", STATE_GAME_OVER, -1, 0.0f, false},
+    {"game_win", STATE_GAME_WIN, -1, 0.0f, false},
+    {"level1_title", STATE_GAME_LEVEL1, 0, 9.8f, true},
+    {"level1_middle", STATE_GAME_LEVEL1, 0, 45.0f, false},
+    {"level1_end", STATE_GAME_LEVEL1, 0, 80.3f, false},
+    {"level2_start", STATE_GAME_LEVEL2, 1, 9.8f, false},
+    {"level2_middle", STATE_GAME_LEVEL2, 1, 45.0f, false},
+    {"level2_end", STATE_GAME_LEVEL2, 1, 80.3f, false},
+    {"level3_start", STATE_GAME_LEVEL3, 2, 9.8f, false},
+    {"level3_middle", STATE_GAME_LEVEL3, 2, 45.0f, false},
+    {"level3_end", STATE_GAME_LEVEL3, 2, 80.3f, false},
+};
+const int GOLDEN_SCENE_COUNT = sizeof(goldenScenes) / sizeof(goldenScenes[0]);
+
+//every scene is drawn this many times and the times averaged, the last frame is the one compared
+#define GOLDEN_FRAMES 30
+//drivers round blending a little differently, a channel can be this far off and a scene can have this share of pixels off
+#define GOLDEN_CHANNEL_TOLERANCE 4
+#define GOLDEN_PIXEL_TOLERANCE 0.001f
+
+//sets the game up the way the scene shows it, without running Update so nothing moves
+void setupGoldenScene(const GoldenScene &scene) {
+    if(scene.level >= 0) {
+        enterLevel(levels.Start(scene.level));
+        viewMatrix.Identity();
+        viewMatrix.Translate(-scene.cameraX, -player.position.y - 2.0f, 0.0f);
+        previousViewMatrix = viewMatrix;
+    }
+    mode = scene.mode;
+    timer = scene.showTitle ? 0.0f : 1.0f;
+    currentIndex = 0;
+    enemyIndex = 0;
+    if(scene.level < 0) {
+        //the menu runner stops in the middle
+        player.position.x = 0.0f;
+        player.sprite = SheetSprite(psheet, runAnimation[currentIndex], PLAYER_SHEET);
+    }
+}
+
+//renders every scene through the same path as the game loop, prints its time and whether it matches
+//returns false if any scene is missing its reference or is too far from it
+bool runGoldenScenes(const std::string &folder, bool update) {
+    int failed = 0;
+    int missing = 0;
+    for(int i = 0; i < GOLDEN_SCENE_COUNT; i++) {
+        const GoldenScene &scene = goldenScenes[i];
+        setupGoldenScene(scene);
+        
+        int width = lowResTarget.width;
+        int height = lowResTarget.height;
+        if(!lowResTarget.Active()) {
+            SDL_GL_GetDrawableSize(displayWindow, &width, &height);
+        }
+        
+        //glFinish makes the time the whole frame on the GPU too, not just the submission
+        double sceneStart = trace.Now();
+        Uint64 total = 0;
+        int draws = 0;
+        GoldenImage image;
+        FrameSnapshot snapshot;
+        takeSnapshot(snapshot, 0);
+        for(int frame = 0; frame < GOLDEN_FRAMES; frame++) {
+            Uint64 start = SDL_GetPerformanceCounter();
+            RenderArena().Reset();
+            if(lowResTarget.Active()) {
+                lowResTarget.Begin();
+            } else {
+                glViewport(0, 0, width, height);
+            }
+            clearFrame(snapshot.mode);
+            RenderSelect(snapshot, 1.0f);
+            drawSubmitted(NULL, snapshot.level);
+            glFinish();
+            total += SDL_GetPerformanceCounter() - start;
+            
+            if(frame == GOLDEN_FRAMES - 1) {
+                image.ReadFramebuffer(width, height);
+            }
+            draws = CurrentRenderStats().drawCalls;
+            EndRenderStatsFrame();
+        }
+        trace.Complete(scene.name, TRACE_THREAD_MAIN, sceneStart, trace.Now() - sceneStart);
+        float milliseconds = (float)((double)total * 1000.0 / (double)SDL_GetPerformanceFrequency() / GOLDEN_FRAMES);
+        
+        std::string referenceFile = folder + "/" + scene.name + ".png";
+        std::ostringstream result;
+        result << std::fixed << std::setprecision(3) << "golden " << scene.name << " " << milliseconds << "ms " << draws << " draws ";
+        if(update) {
+            result << (image.Save(referenceFile) ? "UPDATED" : "NOT SAVED");
+        } else {
+            GoldenImage reference;
+            if(!reference.Load(referenceFile)) {
+                result << "FAIL no reference " << referenceFile;
+                failed++;
+                missing++;
+            } else {
+                GoldenImage difference;
+                GoldenDifference compared = CompareGoldenImages(image, reference, GOLDEN_CHANNEL_TOLERANCE, &difference);
+                int allowed = (int)(width * height * GOLDEN_PIXEL_TOLERANCE);
+                if(!compared.sizeMatches) {
+                    result << "FAIL rendered " << width << "x" << height << " but the reference is " << reference.width << "x" << reference.height;
+                    failed++;
+                }
+                else if(compared.differentPixels > allowed) {
+                    //the render and where it went wrong go next to the reference for looking at later
+                    image.Save(folder + "/" + scene.name + "_actual.png");
+                    difference.Save(folder + "/" + scene.name + "_difference.png");
+                    result << "FAIL " << compared.differentPixels << " pixels off, largest channel difference " << compared.largestChannelDifference;
+                    failed++;
+                }
+                else {
+                    result << "PASS";
+                }
+            }
+        }
+        cout << result.str() << endl;
+    }
+    cout << "golden " << (GOLDEN_SCENE_COUNT - failed) << " of " << GOLDEN_SCENE_COUNT << " scenes passed" << endl;
+    if(missing > 0) {
+        cout << "golden " << missing << " references missing from " << folder << ", render them on the reference configuration with --golden-update" << endl;
+    }
+    return failed == 0;
+}
+
 int main(int argc, char *argv[])
 {
-    SDL_Init(SDL_INIT_VIDEO);
-    
-    displayWindow = SDL_CreateWindow("My Game", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 640, 360, SDL_WINDOW_OPENGL);
+    //--golden renders without a display through SDL's EGL pbuffer driver, the references come from that driver only
+    //so a machine without it fails instead of comparing a window's picture against them
+    const char *goldenFolder = argumentValue(argc, argv, "--golden");
+    if(goldenFolder != NULL) {
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+    }
+    if(SDL_Init(SDL_INIT_VIDEO) != 0 && goldenFolder != NULL) {
+        cout << "golden needs SDL's offscreen video driver (SDL 2.0.22 or later built with EGL): " << SDL_GetError() << endl;
+        return 1;
+    }
     
-    SDL_GLContext context = SDL_GL_CreateContext(displayWindow);
+    //one file with every asset, loose files are used when it hasn't been built
+    MountAssetPack(RESOURCE_FOLDER"assets.pak");
+    
+    //level meshing and asset decoding share these workers
+    Jobs().Start();
+    //--bench times the job system and the message queues against what they replace and exits
+    //--stress checks the message queues from many threads and exits
+    if(hasArgument(argc, argv, "--bench") || hasArgument(argc, argv, "--stress")) {
+        bool passed = true;
+        if(hasArgument(argc, argv, "--bench")) {
+            RunJobBenchmarks(cout, RESOURCE_FOLDER"level1.txt");
+            RunQueueBenchmarks(cout);
+        }
+        if(hasArgument(argc, argv, "--stress")) {
+            passed = RunQueueStressTests(cout);
+        }
+        Jobs().Stop();
+        SDL_Quit();
+        return passed ? 0 : 1;
+    }
     
-    SDL_GL_MakeCurrent(displayWindow, context);
+    //the render queue draws opaque sprites and tiles front to back against this
+    SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 16);
+    Uint32 windowFlags = goldenFolder != NULL ? SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN : SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE;
+    displayWindow = SDL_CreateWindow("My Game", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 640, 360, windowFlags);
+    
+    //run with --core for a 3.3 core profile context, everything draws from buffer objects either way
+    SDL_GLContext context = CreateRenderContext(displayWindow, ChooseRenderBackend(argc, argv));
+    if(goldenFolder != NULL && context == NULL) {
+        cout << "golden could not create a GL context on the offscreen driver: " << SDL_GetError() << endl;
+        Jobs().Stop();
+        SDL_Quit();
+        return 1;
+    }
     
-#ifdef _WINDOWS
-    glewInit();
-#endif
+    textureUploader.Init(1024 * 1024);
+    //a few thousand quads of text and sprites a frame
+    streamBuffer.Init(4096);
+    //text corners and overlay strings, it grows if a frame ever needs more
+    RenderArena().Init(64 * 1024);
     
     Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 4096);
-    jump = Mix_LoadWAV(RESOURCE_FOLDER"jump.wav");
-    select = Mix_LoadWAV(RESOURCE_FOLDER"select.wav");
-    music1 = Mix_LoadMUS(RESOURCE_FOLDER"music.mp3");
-    music2 = Mix_LoadMUS(RESOURCE_FOLDER"cave.mp3");
-    music3 = Mix_LoadMUS(RESOURCE_FOLDER"night.mp3");
-    win = Mix_LoadMUS(RESOURCE_FOLDER"winner.mp3");
-    lose = Mix_LoadMUS(RESOURCE_FOLDER"lose.mp3");
-    menu = Mix_LoadMUS(RESOURCE_FOLDER"menu.mp3");
     
-    Mix_PlayMusic(menu, -1);
+    //level 1 loads on its own thread alongside everything else
+    levels.AddLevel(RESOURCE_FOLDER"level1.txt", RESOURCE_FOLDER"music.mp3");
+    levels.AddLevel(RESOURCE_FOLDER"level2.txt", RESOURCE_FOLDER"cave.mp3");
+    levels.AddLevel(RESOURCE_FOLDER"level3.txt", RESOURCE_FOLDER"night.mp3");
+    levels.Preload(0);
+    
+    AssetLoader loader;
+    loader.AddSound(RESOURCE_FOLDER"jump.wav", &jump);
+    loader.AddSound(RESOURCE_FOLDER"select.wav", &selectSound);
+    loader.AddMusic(RESOURCE_FOLDER"winner.mp3", &win);
+    loader.AddMusic(RESOURCE_FOLDER"lose.mp3", &lose);
+    loader.AddMusic(RESOURCE_FOLDER"menu.mp3", &menu);
+    loader.AddTexture(RESOURCE_FOLDER"arne_sprites.png", &sheet);
+    loader.AddTexture(RESOURCE_FOLDER"p1_spritesheet.png", &psheet);
+    loader.AddTexture(RESOURCE_FOLDER"p3_spritesheet.png", &angry);
+    loader.AddTexture(RESOURCE_FOLDER"p2_spritesheet.png", &esheet);
+    loader.AddTexture(RESOURCE_FOLDER"pixel_font.png", &fontTexture);
+    loader.AddTexture(RESOURCE_FOLDER"starBackground.png", &bg);
+    loader.LoadAll();
+    
+    //from here the audio thread plays and frees everything, the loader thread only opens level music, landing has no sound yet
+    audio.SetSound(GAME_EVENT_JUMP, jump);
+    audio.SetSound(GAME_EVENT_SELECT, selectSound);
+    audio.SetMusic(GAME_EVENT_MAIN_MENU, menu);
+    audio.SetMusic(GAME_EVENT_WIN, win);
+    audio.SetMusic(GAME_EVENT_LOSE, lose);
+    audio.Start();
+    audio.Post(GAME_EVENT_MAIN_MENU);
+    levels.SetAudio(&audio);
     
     player.position.x = -9.90;
     
     solids = {1, 2, 3, 4, 17, 16, 32, 33, 34};
     
-    sheet = LoadTexture(RESOURCE_FOLDER"arne_sprites.png");
-    
-    psheet = LoadTexture(RESOURCE_FOLDER"p1_spritesheet.png");
-    
-    angry = LoadTexture(RESOURCE_FOLDER"p3_spritesheet.png");
-    
-    esheet = LoadTexture(RESOURCE_FOLDER"p2_spritesheet.png");
-    
-    fontTexture = LoadTexture(RESOURCE_FOLDER"pixel_font.png");
-    
-    bg =LoadTexture(RESOURCE_FOLDER"starBackground.png");
-    
     //Main Menu modelview Matrices
     modelviewMatrix.Identity();
     modelviewMatrix2.Identity();
     modelviewMatrix.Translate(-4.0, 1.5, 0.0);
     modelviewMatrix2.Translate(-4.6, -1.2, 0.0);
-    fontTexture = LoadTexture(RESOURCE_FOLDER"pixel_font.png");
-
     
-    ShaderProgram p(RESOURCE_FOLDER"vertex_textured.glsl", RESOURCE_FOLDER"fragment_textured.glsl");
+    //core contexts only take the #version 330 copies of the shaders
+    const char *vertexShaderFile = RESOURCE_FOLDER"vertex_textured.glsl";
+    const char *fragmentShaderFile = RESOURCE_FOLDER"fragment_textured.glsl";
+    if(CurrentRenderBackend() == RENDER_CORE) {
+        vertexShaderFile = RESOURCE_FOLDER"vertex_textured_core.glsl";
+        fragmentShaderFile = RESOURCE_FOLDER"fragment_textured_core.glsl";
+    }
+    ShaderProgram p(vertexShaderFile, fragmentShaderFile);
     program = p;
     
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    const char *tileMapShaderFile = RESOURCE_FOLDER"fragment_tilemap.glsl";
+    if(CurrentRenderBackend() == RENDER_CORE) {
+        tileMapShaderFile = RESOURCE_FOLDER"fragment_tilemap_core.glsl";
+    }
+    if(hasArgument(argc, argv, "--tile-shader")) {
+        tileMapProgram = new ShaderProgram(vertexShaderFile, tileMapShaderFile);
+    }
+    
+    //integer scaling by default, --sharp-bilinear fills the window at any size
+    if(!hasArgument(argc, argv, "--full-res")) {
+        UpscaleFilter upscaleFilter = UPSCALE_INTEGER;
+        if(hasArgument(argc, argv, "--sharp-bilinear")) {
+            upscaleFilter = UPSCALE_SHARP_BILINEAR;
+            const char *upscaleShaderFile = RESOURCE_FOLDER"fragment_upscale.glsl";
+            if(CurrentRenderBackend() == RENDER_CORE) {
+                upscaleShaderFile = RESOURCE_FOLDER"fragment_upscale_core.glsl";
+            }
+            upscaleProgram = new ShaderProgram(vertexShaderFile, upscaleShaderFile);
+        }
+        //golden scenes are always compared at the full 320x180
+        dynamicResolutionEnabled = lowResTarget.Init(320, 180, upscaleFilter, upscaleProgram) && !hasArgument(argc, argv, "--fixed-res") && goldenFolder == NULL;
+        if(dynamicResolutionEnabled) {
+            dynamicResolution.Init(1000.0f / 60.0f);
+        }
+    }
+    
+#ifdef DEBUG
+    //edit the files in the resource folder while the game runs to see the changes
+    HotReload hotReload(&textureUploader);
+    hotReload.WatchTexture(RESOURCE_FOLDER"arne_sprites.png", sheet);
+    hotReload.WatchTexture(RESOURCE_FOLDER"p1_spritesheet.png", psheet);
+    hotReload.WatchTexture(RESOURCE_FOLDER"p3_spritesheet.png", angry);
+    hotReload.WatchTexture(RESOURCE_FOLDER"p2_spritesheet.png", esheet);
+    hotReload.WatchTexture(RESOURCE_FOLDER"pixel_font.png", fontTexture);
+    hotReload.WatchTexture(RESOURCE_FOLDER"starBackground.png", bg);
+    hotReload.WatchShader(vertexShaderFile, fragmentShaderFile, &program);
+    if(tileMapProgram != NULL) {
+        hotReload.WatchShader(vertexShaderFile, tileMapShaderFile, tileMapProgram);
+    }
+    hotReload.WatchLevels(&levels);
+    hotReload.Start();
+#endif
+    
+    SetBlend(true);
+    SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    //sprites in the same layer share a depth, the later one has to win like it would without the depth test
+    glDepthFunc(GL_LEQUAL);
     
-    glViewport(0, 0, 640, 360);
     Matrix projectionMatrix;
     projectionMatrix.SetOrthoProjection(-9.55f, 9.55f, -4.0f, 4.0f, -1.0f, 1.0f);
     
     
-    //Initalize Time Variables
-    float lastFrameTicks = 0.0f;
-    float accumulator = 0.0f;
-    GameMode oldMode = mode;
+    gpuProfiler.Init();
+    const char *traceFile = argumentValue(argc, argv, "--trace");
+    if(traceFile != NULL) {
+        trace.Open(traceFile);
+    }
+    //CPU frame start times for lining the GPU spans up in the trace
+    const int TRACE_FRAMES = 8;
+    double traceFrameStarts[TRACE_FRAMES] = {0.0};
+    int frameNumber = 0;
+    int tracedGpuFrame = -1;
+    
+    const char *simulationRate = argumentValue(argc, argv, "--sim-rate");
+    if(simulationRate != NULL && atof(simulationRate) > 0.0) {
+        simulationStep = 1.0f / (float)atof(simulationRate);
+    }
+    
+    int exitCode = 0;
+    if(goldenFolder != NULL) {
+        exitCode = runGoldenScenes(goldenFolder, hasArgument(argc, argv, "--golden-update")) ? 0 : 1;
+    }
+    else {
+        //the render thread has something to draw before the first step
+        takeSnapshot(snapshots.Back(), SDL_GetPerformanceCounter());
+        snapshots.Publish();
+        simulationRunning = true;
+        simulationThread = std::thread(runSimulation);
+    }
+    
+    //--count-allocs plays level 1 without touching the controls and fails if any frame after the warm up allocates
+    //frames are counted across every thread, the simulation steps in between included
+#ifdef COUNT_ALLOCATIONS
+    bool countAllocations = hasArgument(argc, argv, "--count-allocs") && goldenFolder == NULL;
+    int countedFrames = 0;
+    int allocatingFrames = 0;
+    size_t mostAllocations = 0;
+    size_t totalAllocations = 0;
+    size_t allocationsBefore = 0;
+    if(countAllocations) {
+        SDL_Event start;
+        SDL_zero(start);
+        start.type = SDL_KEYDOWN;
+        start.key.keysym.scancode = SDL_SCANCODE_SPACE;
+        std::lock_guard<std::mutex> guard(inputLock);
+        pendingInput.push_back(start);
+    }
+#else
+    if(hasArgument(argc, argv, "--count-allocs")) {
+        cout << "--count-allocs needs the CountAllocations build configuration, run the \"NYUCodebase Count Allocations\" scheme" << endl;
+        quitRequested = true;
+        exitCode = 1;
+    }
+#endif
     
     SDL_Event event;
-    bool done = false;
+    bool done = goldenFolder != NULL;
     while (!done) {
-        cout << timer << endl;
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT || event.type == SDL_WINDOWEVENT_CLOSE) {
                 done = true;
             }
-            else if (event.type == SDL_KEYDOWN){
-                if (event.key.keysym.scancode == SDL_SCANCODE_ESCAPE){
-                    if(mode != STATE_PAUSE && (mode == STATE_GAME_LEVEL1 || mode == STATE_GAME_LEVEL2 || mode == STATE_GAME_LEVEL3)) {
-                        Mix_PlayChannel(-1, select, 0);
-                        if(Mix_PlayingMusic() == 1){
-                            Mix_PauseMusic();
-                        }
-                        oldMode = mode;
-                        mode = STATE_PAUSE;
-                    }
-                    else if(mode != STATE_MAIN_MENU && mode == STATE_PAUSE){
-                        Mix_PlayChannel(-1, select, 0);
-                        mode = STATE_MAIN_MENU;
-                        Mix_PlayMusic(menu, -1);
-                    }
-                    else{
-                        done = true;
-                    }
-                }
-                else if(event.key.keysym.scancode == SDL_SCANCODE_SPACE){
-                    if(mode == STATE_MAIN_MENU) {
-                        createMap(RESOURCE_FOLDER"level1.txt");
-                        mode = STATE_GAME_LEVEL1;
-                        Mix_PlayChannel(-1, select, 0);
-                        Mix_PlayMusic(music1, -1);
-                    }
-                    else if(mode == STATE_GAME_OVER || mode == STATE_GAME_WIN ||  mode == STATE_MANUAL) {
-                        mode = STATE_MAIN_MENU;
-                        Mix_PlayChannel(-1, select, 0);
-                        Mix_PlayMusic(menu, -1);
-                    }
-                    else if(mode == STATE_PAUSE){
-                        Mix_ResumeMusic();
-                        mode = oldMode;
-                    }
-                }
-                else if(event.key.keysym.scancode == SDL_SCANCODE_I){
-                    if(mode == STATE_MAIN_MENU){
-                        mode = STATE_MANUAL;
-                        Mix_PlayChannel(-1, select, 0);
-                    }
-                }
-                else if(event.key.keysym.scancode == SDL_SCANCODE_0){
-                    if(mode == STATE_GAME_LEVEL1){
-                        mode = STATE_GAME_LEVEL2;
-                        createMap(RESOURCE_FOLDER"level2.txt");
-                        Mix_PlayMusic(music2, -1);
-                        timer = 0.0;
-                    }
-                    else if(mode == STATE_GAME_LEVEL2){
-                        mode = STATE_GAME_LEVEL3;
-                        createMap(RESOURCE_FOLDER"level3.txt");
-                        Mix_PlayMusic(music3, -1);
-                        timer = 0.0;
-                    }
-                    else if(mode == STATE_GAME_LEVEL3){
-                        mode = STATE_GAME_WIN;
-                        Mix_PlayMusic(win, -1);
-                        timer = 0.0;
-                    }
-                }
+            else if (event.type == SDL_KEYDOWN && event.key.keysym.scancode == SDL_SCANCODE_F3){
+                showProfiler = !showProfiler;
             }
-            else if(event.type == SDL_KEYUP){
-                if(event.key.keysym.scancode == SDL_SCANCODE_LEFT || event.key.keysym.scancode == SDL_SCANCODE_A){
-                    if(mode == STATE_GAME_LEVEL1 || mode == STATE_GAME_LEVEL2 || mode == STATE_GAME_LEVEL3){
-                        player.acceleration.x = 0.0f;
-                        player.velocity.x = 0.0f;
-                    }
-                }
-                else if(event.key.keysym.scancode == SDL_SCANCODE_RIGHT || event.key.keysym.scancode == SDL_SCANCODE_D){
-                    if(mode == STATE_GAME_LEVEL1 || mode == STATE_GAME_LEVEL2 || mode == STATE_GAME_LEVEL3){
-                        player.acceleration.x = 0.0f;
-                        player.velocity.x = 0.0f;
-                    }
-                }
+            else if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP){
+                std::lock_guard<std::mutex> guard(inputLock);
+                pendingInput.push_back(event);
             }
         }
         
-        glClear(GL_COLOR_BUFFER_BIT);
-        
-        if(mode == STATE_GAME_LEVEL1) {
-            glClearColor(0.0f, 0.5f, 1.0f, 1.0f);
+        //the simulation thread can't read the keyboard itself
+        const Uint8 *keys = SDL_GetKeyboardState(NULL);
+        int held = 0;
+        if(keys[SDL_SCANCODE_LEFT] || keys[SDL_SCANCODE_A]) {
+            held |= HELD_LEFT;
         }
-        else if(mode == STATE_GAME_LEVEL3){
-            glClearColor(0.3f, 0.0f, 1.0f, 1.0f);
+        if(keys[SDL_SCANCODE_RIGHT] || keys[SDL_SCANCODE_D]) {
+            held |= HELD_RIGHT;
         }
-        else{
-            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        if(keys[SDL_SCANCODE_UP] || keys[SDL_SCANCODE_W]) {
+            held |= HELD_UP;
+        }
+        heldKeys = held;
+        if(quitRequested) {
+            done = true;
         }
         
-        glUseProgram(program.programID);
+#ifdef DEBUG
+        hotReload.Apply();
+        hotReload.ApplyLevels(simulationLock);
+#endif
+        //a quarter megabyte of texture rows per frame at most
+        textureUploader.Update(256 * 1024);
+        
+        UseProgram(program.programID);
         
         program.SetProjectionMatrix(projectionMatrix);
+        if(tileMapProgram != NULL) {
+            tileMapProgram->SetProjectionMatrix(projectionMatrix);
+            UseProgram(program.programID);
+        }
         
-        float ticks = (float)SDL_GetTicks()/1000.0f;
-        float elapsed = ticks - lastFrameTicks;
-        lastFrameTicks = ticks;
+        //the newest step the simulation has finished, drawn up to one step after it ended
+        snapshots.Acquire();
+        const FrameSnapshot &frame = snapshots.Front();
+        cout << frame.timer << endl;
+        float interpolation = (float)((double)(SDL_GetPerformanceCounter() - frame.stepEnd) / (double)SDL_GetPerformanceFrequency()) / simulationStep;
+        if(interpolation > 1.0f) {
+            interpolation = 1.0f;
+        }
+        else if(interpolation < 0.0f) {
+            interpolation = 0.0f;
+        }
+        double frameStart = trace.Now();
+        //nothing drawn last frame is still using it
+        RenderArena().Reset();
         
-        elapsed += accumulator;
-        if(elapsed < FIXED_TIMESTEP) {
-            accumulator = elapsed;
-            continue;
+        //the window can be resized, the drawable can be bigger than the window on high dpi screens
+        int drawableWidth, drawableHeight;
+        SDL_GL_GetDrawableSize(displayWindow, &drawableWidth, &drawableHeight);
+        //every GL call of the frame is timed from here
+        if(dynamicResolutionEnabled) {
+            dynamicResolution.BeginFrame();
         }
-        while(elapsed >= FIXED_TIMESTEP) {
-            Update(FIXED_TIMESTEP);
-            elapsed -= FIXED_TIMESTEP;
-            animationElapsed += elapsed;
-            if(animationElapsed > 1.0/framesPerSecond){
-                currentIndex++;
-                enemyIndex++;
-                animationElapsed = 0.0;
-                
-                if(currentIndex > numFrames - 1) {
-                    currentIndex = 0;
-                }
-                if(enemyIndex > eFrames - 1) {
-                    enemyIndex = 0;
-                }
+        if(lowResTarget.Active()) {
+            lowResTarget.Begin();
+        } else {
+            glViewport(0, 0, drawableWidth, drawableHeight);
+        }
+        
+        gpuProfiler.BeginFrame();
+        gpuProfiler.Begin(GPU_PASS_BACKGROUND);
+        clearFrame(frame.mode);
+        
+        RenderSelect(frame, interpolation);
+        if(showProfiler) {
+            drawProfilerOverlay();
+        }
+        double submitEnd = trace.Now();
+        trace.Complete("submit", TRACE_THREAD_MAIN, frameStart, submitEnd - frameStart);
+        
+        drawSubmitted(&gpuProfiler, frame.level);
+        double flushEnd = trace.Now();
+        trace.Complete("flush", TRACE_THREAD_MAIN, submitEnd, flushEnd - submitEnd);
+        
+        if(lowResTarget.Active()) {
+            gpuProfiler.Begin(GPU_PASS_POST);
+            lowResTarget.Present(drawableWidth, drawableHeight);
+            if(dynamicResolutionEnabled && dynamicResolution.EndFrame()) {
+                lowResTarget.SetSize(dynamicResolution.Width(), dynamicResolution.Height());
             }
-            
         }
-        accumulator = elapsed;
+        gpuProfiler.EndFrame();
+        trace.Complete("present", TRACE_THREAD_MAIN, flushEnd, trace.Now() - flushEnd);
         
-        RenderSelect(elapsed);
+        //GPU spans are placed after the start of the CPU frame that issued them
+        traceFrameStarts[frameNumber % TRACE_FRAMES] = frameStart;
+        frameNumber++;
+        if(trace.IsOpen() && gpuProfiler.frameNumber != tracedGpuFrame) {
+            tracedGpuFrame = gpuProfiler.frameNumber;
+            double gpuFrameStart = traceFrameStarts[tracedGpuFrame % TRACE_FRAMES];
+            for(size_t i = 0; i < gpuProfiler.spans.size(); i++) {
+                const GpuSpan &span = gpuProfiler.spans[i];
+                trace.Complete(GpuProfiler::PassName(span.pass), TRACE_THREAD_GPU, gpuFrameStart + span.start * 1000.0, span.duration * 1000.0);
+            }
+        }
         
         SDL_GL_SwapWindow(displayWindow);
+        EndRenderStatsFrame();
+        
+#ifdef COUNT_ALLOCATIONS
+        if(countAllocations && frameNumber == ALLOCATION_WARMUP_FRAMES) {
+            //level 2 loading in the background would be counted against these frames
+            levels.WaitForPreload();
+            allocationsBefore = AllocationCount();
+        }
+        else if(countAllocations && frameNumber > ALLOCATION_WARMUP_FRAMES) {
+            size_t allocations = AllocationCount() - allocationsBefore;
+            allocationsBefore += allocations;
+            totalAllocations += allocations;
+            if(allocations > 0) {
+                allocatingFrames++;
+            }
+            if(allocations > mostAllocations) {
+                mostAllocations = allocations;
+            }
+            countedFrames++;
+            if(countedFrames == ALLOCATION_COUNTED_FRAMES) {
+                cout << "allocations " << totalAllocations << " in " << countedFrames << " frames, " << allocatingFrames << " frames allocated, at most " << mostAllocations << " in one frame" << endl;
+                exitCode = allocatingFrames == 0 ? 0 : 1;
+                done = true;
+            }
+        }
+#endif
+    }
+    
+    simulationRunning = false;
+    if(simulationThread.joinable()) {
+        simulationThread.join();
+    }
+    
+    levels.WaitForPreload();
+    Jobs().Stop();
+    audio.Stop();
+    
+    GLStateCounters &stateCalls = GetGLStateCounters();
+    cout << "GL state cache filtered " << stateCalls.filtered << " of " << (stateCalls.filtered + stateCalls.issued) << " state calls" << endl;
+    PrintRenderStatsHistograms(cout);
+    
+    streamBuffer.Release();
+    RenderArena().Release();
+    ReleaseQuadIndexBuffer();
+    backgroundMesh.Release();
+    delete tileMapProgram;
+    lowResTarget.Release();
+    dynamicResolution.Release();
+    gpuProfiler.Release();
+    trace.Close();
+    delete upscaleProgram;
+    levels.ReleaseRetired();
+    if(levels.current != NULL) {
+        levels.current->ReleaseMeshes();
     }
     
     Mix_FreeChunk(jump);
-    Mix_FreeMusic(music1);
-    Mix_FreeMusic(music2);
-    Mix_FreeMusic(music3);
     Mix_FreeMusic(menu);
     Mix_FreeMusic(lose);
     Mix_FreeMusic(win);
     
     SDL_Quit();
-    return 0;
+    return exitCode;
 }
 
 
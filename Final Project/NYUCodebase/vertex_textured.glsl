@@ -1,13 +1,16 @@
 attribute vec4 position;
 attribute vec2 texCoord;
+attribute vec4 color;
 
 uniform mat4 modelviewMatrix;
 uniform mat4 projectionMatrix;
 
 varying vec2 texCoordVar;
+varying vec4 colorVar;
 
 void main()
 {
     texCoordVar = texCoord;
+    colorVar = color;
 	gl_Position = projectionMatrix * modelviewMatrix  * position;
 }
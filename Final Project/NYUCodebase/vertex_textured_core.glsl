@@ -0,0 +1,18 @@
+#version 330 core
+
+in vec4 position;
+in vec2 texCoord;
+in vec4 color;
+
+uniform mat4 modelviewMatrix;
+uniform mat4 projectionMatrix;
+
+out vec2 texCoordVar;
+out vec4 colorVar;
+
+void main()
+{
+    texCoordVar = texCoord;
+    colorVar = color;
+	gl_Position = projectionMatrix * modelviewMatrix  * position;
+}
@@ -0,0 +1,101 @@
+// Builds the asset pack the game memory maps at startup.
+//
+//   c++ -std=c++11 packassets.cpp -o packassets
+//   ./packassets NYUCodebase.app/Contents/Resources/assets.pak *.png *.wav *.mp3 *.txt NYUCodebase/*.glsl
+//
+// Assets are stored under their file name, so the game finds "arne_sprites.png"
+// whatever folder RESOURCE_FOLDER points at.
+
+#include "../NYUCodebase/PackFormat.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+
+class PackInput {
+    public:
+        std::string name;
+        std::string contents;
+};
+
+static bool byName(const PackInput &a, const PackInput &b) {
+    return strncmp(a.name.c_str(), b.name.c_str(), PACK_NAME_LENGTH) < 0;
+}
+
+static uint64_t aligned(uint64_t offset) {
+    return (offset + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+}
+
+int main(int argc, char *argv[]) {
+    if(argc < 3) {
+        std::cout << "usage: packassets output.pak asset [asset...]" << std::endl;
+        return 1;
+    }
+
+    std::vector<PackInput> inputs;
+    for(int i = 2; i < argc; i++) {
+        std::string path = argv[i];
+        std::ifstream infile(path, std::ios::binary);
+        if(infile.fail()) {
+            std::cout << "Unable to open " << path << std::endl;
+            return 1;
+        }
+        PackInput input;
+        size_t slash = path.find_last_of("/\\");
+        input.name = slash == std::string::npos ? path : path.substr(slash + 1);
+        if(input.name.size() >= PACK_NAME_LENGTH) {
+            std::cout << "Asset name too long: " << input.name << std::endl;
+            return 1;
+        }
+        std::stringstream buffer;
+        buffer << infile.rdbuf();
+        input.contents = buffer.str();
+        inputs.push_back(input);
+    }
+    std::sort(inputs.begin(), inputs.end(), byName);
+    for(size_t i = 1; i < inputs.size(); i++) {
+        if(inputs[i].name == inputs[i - 1].name) {
+            std::cout << "Duplicate asset name: " << inputs[i].name << std::endl;
+            return 1;
+        }
+    }
+
+    PackHeader header;
+    memcpy(header.magic, PACK_MAGIC, 4);
+    header.version = PACK_VERSION;
+    header.entryCount = (uint32_t)inputs.size();
+    header.reserved = 0;
+
+    std::vector<PackEntry> entries(inputs.size());
+    uint64_t offset = aligned(sizeof(PackHeader) + inputs.size() * sizeof(PackEntry));
+    for(size_t i = 0; i < inputs.size(); i++) {
+        memset(&entries[i], 0, sizeof(PackEntry));
+        strncpy(entries[i].name, inputs[i].name.c_str(), PACK_NAME_LENGTH - 1);
+        entries[i].offset = offset;
+        entries[i].size = inputs[i].contents.size();
+        offset = aligned(offset + inputs[i].contents.size());
+    }
+
+    std::ofstream outfile(argv[1], std::ios::binary);
+    if(outfile.fail()) {
+        std::cout << "Unable to write " << argv[1] << std::endl;
+        return 1;
+    }
+    outfile.write((const char*)&header, sizeof(header));
+    outfile.write((const char*)entries.data(), entries.size() * sizeof(PackEntry));
+    uint64_t written = sizeof(header) + entries.size() * sizeof(PackEntry);
+    static const char padding[PACK_ALIGNMENT] = {0};
+    for(size_t i = 0; i < inputs.size(); i++) {
+        outfile.write(padding, entries[i].offset - written);
+        outfile.write(inputs[i].contents.data(), inputs[i].contents.size());
+        written = entries[i].offset + inputs[i].contents.size();
+    }
+    outfile.write(padding, aligned(written) - written);
+
+    std::cout << "Packed " << inputs.size() << " assets into " << argv[1] << " (" << aligned(written) << " bytes)" << std::endl;
+    return 0;
+}